@@ -0,0 +1,154 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <stop_token>
+#include <thread>
+#include <utility>
+
+#include "libsanjego/bot.hpp"
+#include "libsanjego/deadline.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/search.hpp"
+#include "libsanjego/types.hpp"
+
+namespace libsanjego {
+/*
+ * Explores a position on a thread of its own, so that the caller can do
+ * other work meanwhile, watch the progress of the search, and stop it at any
+ * time, for example because the opponent has disconnected or the clock is
+ * running low.
+ *
+ * The search stops once its deadline has passed, Stop is called, the given
+ * stop token is triggered, or the object is destroyed. The explorer must
+ * outlive it and must not be used by others while it runs. Progress reports
+ * are passed on to the explorer's own progress callback.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class AsyncSearch {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+  AsyncSearch(Explorer<HEIGHT, WIDTH, RULES> &explorer,
+              const Board<HEIGHT, WIDTH> &board, Color active_player,
+              clock::time_point deadline = clock::time_point::max(),
+              std::stop_token stop_token = {});
+  AsyncSearch(const AsyncSearch &other) = delete;
+  AsyncSearch &operator=(const AsyncSearch &other) = delete;
+
+  /*
+   * Asks the search to stop soon. Its result is still available afterwards.
+   */
+  void Stop() noexcept { thread_.request_stop(); }
+
+  /*
+   * Gives the search more or less time than planned.
+   */
+  void MoveDeadlineTo(const clock::time_point deadline) noexcept {
+    deadline_.MoveTo(deadline);
+  }
+
+  [[nodiscard]] bool IsDone() const noexcept {
+    return result_.wait_for(std::chrono::seconds(0)) ==
+           std::future_status::ready;
+  }
+
+  /*
+   * Waits for the search to end and returns its result.
+   */
+  SearchResult Wait() noexcept { return result_.get(); }
+
+  /*
+   * Returns the latest progress report, or nothing if there is none yet.
+   */
+  [[nodiscard]] std::optional<SearchProgress> progress() const noexcept {
+    const std::scoped_lock lock(mutex_);
+    return progress_;
+  }
+
+  /*
+   * Returns the best move of the latest progress report, which a
+   * preempted caller can play right away.
+   */
+  [[nodiscard]] std::optional<Move> CurrentBestMove() const noexcept {
+    const std::scoped_lock lock(mutex_);
+    if (not progress_.has_value() ||
+        progress_->principal_variation.empty()) {
+      return {};
+    }
+    return progress_->principal_variation.front();
+  }
+
+ private:
+  Explorer<HEIGHT, WIDTH, RULES> &explorer_;
+  Deadline deadline_;
+  mutable std::mutex mutex_;
+  std::optional<SearchProgress> progress_;
+  std::shared_future<SearchResult> result_;
+  // declared last so that it is stopped and joined before the rest goes
+  std::jthread thread_;
+
+  void Run(const Board<HEIGHT, WIDTH> &board, Color active_player,
+           std::promise<SearchResult> &promise) noexcept;
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+AsyncSearch<HEIGHT, WIDTH, RULES>::AsyncSearch(
+    Explorer<HEIGHT, WIDTH, RULES> &explorer,
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    const clock::time_point deadline, std::stop_token stop_token)
+    : explorer_(explorer), deadline_(deadline) {
+  std::promise<SearchResult> promise;
+  result_ = promise.get_future().share();
+  thread_ = std::jthread(
+      [this, board, active_player, stop_token = std::move(stop_token),
+       promise = std::move(promise)](std::stop_token own_stop_token) mutable {
+        const auto stop = [this] {
+          deadline_.MoveTo(clock::time_point::min());
+        };
+        const std::stop_callback on_own_stop(own_stop_token, stop);
+        const std::stop_callback on_stop(stop_token, stop);
+        Run(board, active_player, promise);
+      });
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+void AsyncSearch<HEIGHT, WIDTH, RULES>::Run(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    std::promise<SearchResult> &promise) noexcept {
+  auto callback = explorer_.progress_callback();
+  explorer_.ReportProgressTo([this, &callback](const SearchProgress &progress) {
+    {
+      const std::scoped_lock lock(mutex_);
+      progress_ = progress;
+    }
+    if (callback) {
+      callback(progress);
+    }
+  });
+  auto result = explorer_.Explore(board, active_player, deadline_);
+  explorer_.ReportProgressTo(std::move(callback));
+  promise.set_value(std::move(result));
+}
+}  // namespace libsanjego
@@ -19,15 +19,27 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <memory>
 #include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "libsanjego/deadline.hpp"
 #include "libsanjego/gameobjects.hpp"
 #include "libsanjego/rulesets.hpp"
+#include "libsanjego/scheduler.hpp"
+#include "libsanjego/search.hpp"
+#include "libsanjego/tablebase.hpp"
+#include "libsanjego/transposition.hpp"
 #include "libsanjego/types.hpp"
+#include "libsanjego/ybwc.hpp"
 
 namespace libsanjego {
 
@@ -44,65 +56,491 @@ struct SearchResult {
   uint8_t max_explored_depth;
   // Marks whether there is an enforceable win for a color.
   std::optional<Color> winner;
+  // the final value of the game from the first player's point of view under
+  // optimal play, if the search could prove it
+  std::optional<game_value_t> proven_value;
+  // the line of play the search expects, starting with best_move; its second
+  // move is the reply worth pondering on
+  std::vector<Move> principal_variation;
 };
 
 /*
  * An explorer expands nodes of a game tree to find notable states.
  */
-template <board_size_t HEIGHT, board_size_t WIDTH>
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
 class Explorer {
  public:
+  typedef std::chrono::steady_clock clock;
+
   /*
-   * Creates an explorer backed by the standard rule set.
+   * Creates an explorer backed by the given rule set, which is the standard
+   * rule set unless the explorer is instantiated with another one.
    */
-  explicit Explorer()
-      : rules_(std::make_unique<StandardRuleset<HEIGHT, WIDTH>>()) {}
+  explicit Explorer(RULES rules = RULES()) : rules_(std::move(rules)) {}
+  virtual ~Explorer() = default;
   virtual SearchResult Explore(const Board<HEIGHT, WIDTH> &board,
                                Color active_player) noexcept = 0;
 
+  /*
+   * Explores the game tree until the deadline has passed and returns the best
+   * move found so far. The deadline may be moved during the search.
+   */
+  virtual SearchResult Explore(const Board<HEIGHT, WIDTH> &board,
+                               Color active_player,
+                               const Deadline &deadline) noexcept = 0;
+
+  /*
+   * Explores the game tree until the given point in time.
+   */
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                       clock::time_point deadline) noexcept {
+    const Deadline fixed_deadline(deadline);
+    return Explore(board, active_player, fixed_deadline);
+  }
+
+  /*
+   * Explores the game tree for the given amount of time.
+   */
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                       clock::duration budget) noexcept {
+    return Explore(board, active_player, clock::now() + budget);
+  }
+
+  /*
+   * Makes all following searches look up positions with few towers in the
+   * given tablebase. Passing nullptr stops using a tablebase.
+   */
+  void UseTablebase(
+      std::shared_ptr<const Tablebase<HEIGHT, WIDTH>> tablebase) noexcept {
+    tablebase_ = std::move(tablebase);
+  }
+
+  /*
+   * Makes all following searches share transposition table entries between
+   * positions that are equivalent by mirroring, rotating or swapping colors.
+   * Explorers without a transposition table ignore this.
+   */
+  void UseSymmetricKeys(bool enabled) noexcept {
+    uses_symmetric_keys_ = enabled;
+  }
+
+  /*
+   * Makes all following searches report their progress to the given
+   * callback, which is called on a searching thread. Alpha-beta searches
+   * report every completed iteration, Monte-Carlo searches only their end
+   * result. Passing an empty callback stops the reports.
+   */
+  void ReportProgressTo(ProgressCallback callback) noexcept {
+    progress_callback_ = std::move(callback);
+  }
+  [[nodiscard]] const ProgressCallback &progress_callback() const noexcept {
+    return progress_callback_;
+  }
+
  protected:
-  // TODO allow general rule sets
-  std::unique_ptr<StandardRuleset<HEIGHT, WIDTH>> rules_;
+  // only ever read, so that all threads of a search can share it
+  const RULES rules_;
+  std::shared_ptr<const Tablebase<HEIGHT, WIDTH>> tablebase_;
+  bool uses_symmetric_keys_ = false;
+  ProgressCallback progress_callback_;
+
+  // what searches need to report to the progress callback
+  [[nodiscard]] const ProgressCallback *progress_callback_or_null()
+      const noexcept {
+    return progress_callback_ ? &progress_callback_ : nullptr;
+  }
 };
 
-template <board_size_t HEIGHT, board_size_t WIDTH>
-class FullExplorer : Explorer<HEIGHT, WIDTH> {
+/*
+ * Number of half-turns a FullExplorer looks ahead unless told otherwise.
+ */
+constexpr uint8_t DEFAULT_SEARCH_DEPTH = 4;
+
+/*
+ * Size of the transposition table a FullExplorer creates for itself unless
+ * it is given one.
+ */
+constexpr std::size_t DEFAULT_TRANSPOSITION_TABLE_SIZE_IN_MB = 16;
+
+namespace details {
+inline std::optional<Color> WinnerOf(
+    const std::optional<game_value_t> proven_value) noexcept {
+  if (not proven_value.has_value() || proven_value.value() == 0) {
+    return {};
+  }
+  return proven_value.value() > 0 ? Color::Blue : Color::Yellow;
+}
+
+template <typename SEARCH>
+SearchResult Summarize(SEARCH &search,
+                       const Move best_move,
+                       const std::chrono::steady_clock::time_point start) {
+  const std::chrono::duration<double> seconds_spent =
+      std::chrono::steady_clock::now() - start;
+  return SearchResult{
+      .num_explored_nodes = search.num_explored_nodes(),
+      .seconds_spent = seconds_spent.count(),
+      .best_move = best_move,
+      .max_explored_depth = search.max_explored_depth(),
+      .winner = WinnerOf(search.proven_value()),
+      .proven_value = search.proven_value(),
+      .principal_variation = search.PrincipalVariation(best_move),
+  };
+}
+}  // namespace details
+
+/*
+ * Explores the game tree with an alpha-beta pruned negamax search.
+ * Without a deadline, the search goes to a fixed depth. Otherwise, it deepens
+ * iteratively until the time is up.
+ * Search results are cached in a transposition table that may be shared with
+ * other explorers.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class FullExplorer : public Explorer<HEIGHT, WIDTH, RULES> {
  public:
+  typedef typename Explorer<HEIGHT, WIDTH, RULES>::clock clock;
+  using Explorer<HEIGHT, WIDTH, RULES>::Explore;
+
+  explicit FullExplorer(
+      uint8_t search_depth = DEFAULT_SEARCH_DEPTH,
+      std::shared_ptr<TranspositionTable> transposition_table =
+          std::make_shared<TranspositionTable>(
+              DEFAULT_TRANSPOSITION_TABLE_SIZE_IN_MB))
+      : search_depth_(std::max<uint8_t>(search_depth, 1)),
+        transposition_table_(std::move(transposition_table)) {}
   SearchResult Explore(const Board<HEIGHT, WIDTH> &board,
-                       Color active_player) noexcept;
+                       Color active_player) noexcept override;
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                       const Deadline &deadline) noexcept override;
+
+  [[nodiscard]] const TranspositionTable &transposition_table() const noexcept {
+    return *transposition_table_;
+  }
+
+ private:
+  uint8_t search_depth_;
+  std::shared_ptr<TranspositionTable> transposition_table_;
 };
 
 /*
  * Searches the game tree to find interesting states and strong moves.
  * Returns a move considered "best" as well as some statistics on the search.
  */
-template <board_size_t HEIGHT, board_size_t WIDTH>
-SearchResult FullExplorer<HEIGHT, WIDTH>::Explore(
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+SearchResult FullExplorer<HEIGHT, WIDTH, RULES>::Explore(
     const Board<HEIGHT, WIDTH> &board, const Color active_player) noexcept {
-  const auto start = std::chrono::steady_clock::now();
-  auto possible_moves = this->rules_->GetLegalMoves(board, active_player);
-  auto best_move = Move::Skip();
-  if (!possible_moves.empty()) {
-    auto max_rating = std::numeric_limits<game_value_t>::min();
-    auto tmp_board(board);
-    for (auto &move : possible_moves) {
-      tmp_board.Make(move);
-      const auto rating = this->rules_->ComputeValueOf(tmp_board);
-      tmp_board.Undo(move);
-      if (rating > max_rating) {
-        max_rating = rating;
-        best_move = move;
-      }
+  const auto start = clock::now();
+  transposition_table_->NewSearch();
+  const Deadline deadline;
+  AlphaBetaSearch<HEIGHT, WIDTH, RULES> search(
+      this->rules_, *transposition_table_, board, active_player, deadline);
+  search.UseTablebase(this->tablebase_.get());
+  if (this->uses_symmetric_keys_) {
+    search.EnableSymmetricKeys();
+  }
+  search.ReportProgressTo(this->progress_callback_or_null());
+  const auto best_move = search.SearchRoot(search_depth_).value();
+  return details::Summarize(search, best_move, start);
+}
+
+/*
+ * Deepens the search one half-turn at a time until the deadline has passed or
+ * the game tree has been searched completely.
+ * Returns the best move of the deepest completed iteration.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+SearchResult FullExplorer<HEIGHT, WIDTH, RULES>::Explore(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    const Deadline &deadline) noexcept {
+  const auto start = clock::now();
+  transposition_table_->NewSearch();
+  AlphaBetaSearch<HEIGHT, WIDTH, RULES> search(
+      this->rules_, *transposition_table_, board, active_player, deadline);
+  search.UseTablebase(this->tablebase_.get());
+  if (this->uses_symmetric_keys_) {
+    search.EnableSymmetricKeys();
+  }
+  search.ReportProgressTo(this->progress_callback_or_null());
+  const auto best_move =
+      search.IterativelyDeepen(1, std::numeric_limits<uint8_t>::max());
+  return details::Summarize(search, best_move, start);
+}
+
+/*
+ * Explores the game tree with several threads at once following the Lazy SMP
+ * scheme: every thread runs its own iteratively deepening alpha-beta search
+ * of the whole tree, and they only cooperate through a shared transposition
+ * table. Helper threads start one half-turn deeper every other thread and
+ * search moves in a perturbed order, so that they fill the table with
+ * results the main thread needs soon.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class LazySmpExplorer : public Explorer<HEIGHT, WIDTH, RULES> {
+ public:
+  typedef typename Explorer<HEIGHT, WIDTH, RULES>::clock clock;
+  using Explorer<HEIGHT, WIDTH, RULES>::Explore;
+
+  /*
+   * Creates an explorer that uses the given number of threads, or one per
+   * hardware thread if it is 0.
+   */
+  explicit LazySmpExplorer(
+      unsigned int num_threads = 0,
+      uint8_t search_depth = DEFAULT_SEARCH_DEPTH,
+      std::shared_ptr<TranspositionTable> transposition_table =
+          std::make_shared<TranspositionTable>(
+              DEFAULT_TRANSPOSITION_TABLE_SIZE_IN_MB))
+      : num_threads_(num_threads > 0
+                         ? num_threads
+                         : std::max(std::thread::hardware_concurrency(), 1U)),
+        search_depth_(std::max<uint8_t>(search_depth, 1)),
+        transposition_table_(std::move(transposition_table)) {}
+
+  /*
+   * Searches to the configured depth; the result is taken from the main
+   * thread, which the helpers speed up.
+   */
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board,
+                       Color active_player) noexcept override {
+    const Deadline deadline;
+    return ExploreInParallel(board, active_player, deadline, search_depth_);
+  }
+
+  /*
+   * Searches until the deadline has passed. The result is taken from the
+   * thread that completed the deepest iteration.
+   */
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                       const Deadline &deadline) noexcept override {
+    return ExploreInParallel(board, active_player, deadline,
+                             std::numeric_limits<uint8_t>::max());
+  }
+
+  [[nodiscard]] unsigned int num_threads() const noexcept {
+    return num_threads_;
+  }
+  [[nodiscard]] const TranspositionTable &transposition_table() const noexcept {
+    return *transposition_table_;
+  }
+
+ private:
+  unsigned int num_threads_;
+  uint8_t search_depth_;
+  std::shared_ptr<TranspositionTable> transposition_table_;
+
+  SearchResult ExploreInParallel(const Board<HEIGHT, WIDTH> &board,
+                                 Color active_player,
+                                 const Deadline &deadline,
+                                 uint8_t max_depth) noexcept;
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+SearchResult LazySmpExplorer<HEIGHT, WIDTH, RULES>::ExploreInParallel(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    const Deadline &deadline, const uint8_t max_depth) noexcept {
+  const auto start = clock::now();
+  transposition_table_->NewSearch();
+
+  // The helpers keep searching until the main thread is done.
+  std::atomic<bool> stop_signal = false;
+  std::vector<AlphaBetaSearch<HEIGHT, WIDTH, RULES>> searches;
+  searches.reserve(num_threads_);
+  for (unsigned int index = 0; index < num_threads_; ++index) {
+    const auto *const signal = index == 0 ? nullptr : &stop_signal;
+    searches.emplace_back(this->rules_, *transposition_table_, board,
+                          active_player, deadline, signal, index);
+    searches.back().UseTablebase(this->tablebase_.get());
+    if (this->uses_symmetric_keys_) {
+      searches.back().EnableSymmetricKeys();
     }
   }
-  const auto end = std::chrono::steady_clock::now();
-  const std::chrono::duration<double> seconds_spent = end - start;
+  // the helpers' iterations are out of step with the main thread
+  searches.front().ReportProgressTo(this->progress_callback_or_null());
+  std::vector<Move> best_moves(num_threads_, Move::Skip());
+
+  std::vector<std::thread> helpers;
+  helpers.reserve(num_threads_ - 1);
+  for (unsigned int index = 1; index < num_threads_; ++index) {
+    helpers.emplace_back([&searches, &best_moves, index] {
+      best_moves[index] = searches[index].IterativelyDeepen(
+          1 + index % 2, std::numeric_limits<uint8_t>::max());
+    });
+  }
+  best_moves[0] = searches[0].IterativelyDeepen(1, max_depth);
+  stop_signal.store(true, std::memory_order_relaxed);
+  for (auto &helper : helpers) {
+    helper.join();
+  }
+
+  // A fixed-depth search trusts the main thread, a timed search the thread
+  // that got the deepest.
+  std::size_t best_index = 0;
+  uint64_t num_explored_nodes = 0;
+  uint8_t max_explored_depth = 0;
+  std::optional<game_value_t> proven_value;
+  for (std::size_t index = 0; index < searches.size(); ++index) {
+    if (not proven_value.has_value()) {
+      proven_value = searches[index].proven_value();
+    }
+    num_explored_nodes += searches[index].num_explored_nodes();
+    max_explored_depth =
+        std::max(max_explored_depth, searches[index].max_explored_depth());
+    if (deadline.time_point() != clock::time_point::max() &&
+        searches[index].completed_depth() >
+            searches[best_index].completed_depth()) {
+      best_index = index;
+    }
+  }
+
+  const std::chrono::duration<double> seconds_spent = clock::now() - start;
   return SearchResult{
-      .num_explored_nodes = possible_moves.size(),
+      .num_explored_nodes = num_explored_nodes,
       .seconds_spent = seconds_spent.count(),
-      .best_move = best_move,
-      .max_explored_depth = 1,
-      .winner = {},
+      .best_move = best_moves[best_index],
+      .max_explored_depth = max_explored_depth,
+      .winner = details::WinnerOf(proven_value),
+      .proven_value = proven_value,
+      .principal_variation =
+          searches[best_index].PrincipalVariation(best_moves[best_index]),
   };
 }
+
+/*
+ * Explores the game tree with a Young Brothers Wait Concept search: the
+ * first move at each node is searched serially, and only then are its
+ * siblings distributed over a pool of threads that steal work from each
+ * other. Compared to Lazy SMP, the threads search disjoint parts of the tree,
+ * which pays off on wide boards with many moves per position.
+ * Like FullExplorer, it deepens iteratively until a deadline if one is given,
+ * but stops at a fixed depth otherwise.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class YbwcExplorer : public Explorer<HEIGHT, WIDTH, RULES> {
+ public:
+  typedef typename Explorer<HEIGHT, WIDTH, RULES>::clock clock;
+  using Explorer<HEIGHT, WIDTH, RULES>::Explore;
+
+  /*
+   * Creates an explorer that uses the given number of threads, or one per
+   * hardware thread if it is 0.
+   */
+  explicit YbwcExplorer(
+      unsigned int num_threads = 0,
+      uint8_t search_depth = DEFAULT_SEARCH_DEPTH,
+      std::shared_ptr<TranspositionTable> transposition_table =
+          std::make_shared<TranspositionTable>(
+              DEFAULT_TRANSPOSITION_TABLE_SIZE_IN_MB))
+      : scheduler_(std::make_unique<WorkStealingScheduler>(
+            num_threads > 0
+                ? num_threads
+                : std::max(std::thread::hardware_concurrency(), 1U))),
+        search_depth_(std::max<uint8_t>(search_depth, 1)),
+        transposition_table_(std::move(transposition_table)) {}
+
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board,
+                       Color active_player) noexcept override {
+    const Deadline deadline;
+    return ExploreInParallel(board, active_player, deadline, search_depth_);
+  }
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                       const Deadline &deadline) noexcept override {
+    return ExploreInParallel(board, active_player, deadline,
+                             std::numeric_limits<uint8_t>::max());
+  }
+
+  [[nodiscard]] unsigned int num_threads() const noexcept {
+    return scheduler_->num_workers();
+  }
+  [[nodiscard]] const TranspositionTable &transposition_table() const noexcept {
+    return *transposition_table_;
+  }
+
+ private:
+  std::unique_ptr<WorkStealingScheduler> scheduler_;
+  uint8_t search_depth_;
+  std::shared_ptr<TranspositionTable> transposition_table_;
+
+  SearchResult ExploreInParallel(const Board<HEIGHT, WIDTH> &board,
+                                 const Color active_player,
+                                 const Deadline &deadline,
+                                 const uint8_t max_depth) noexcept {
+    const auto start = clock::now();
+    transposition_table_->NewSearch();
+    YbwcSearch<HEIGHT, WIDTH, RULES> search(this->rules_, *transposition_table_,
+                                            *scheduler_, board, active_player,
+                                            deadline);
+    search.UseTablebase(this->tablebase_.get());
+    if (this->uses_symmetric_keys_) {
+      search.EnableSymmetricKeys();
+    }
+    search.ReportProgressTo(this->progress_callback_or_null());
+    const auto best_move = search.IterativelyDeepen(max_depth);
+    return details::Summarize(search, best_move, start);
+  }
+};
+
+/*
+ * Solves the game from the given position: it searches until the end of the
+ * game to find the winner and the final value under optimal play, pruning
+ * lines whose outcome is already settled by the shape of the board.
+ * With a deadline, it gives up solving once the time is up and returns the
+ * best move found so far without a winner, which makes it usable for
+ * endgames on larger boards during live play.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class SolvingExplorer : public Explorer<HEIGHT, WIDTH, RULES> {
+ public:
+  typedef typename Explorer<HEIGHT, WIDTH, RULES>::clock clock;
+  using Explorer<HEIGHT, WIDTH, RULES>::Explore;
+
+  explicit SolvingExplorer(
+      std::shared_ptr<TranspositionTable> transposition_table =
+          std::make_shared<TranspositionTable>(
+              DEFAULT_TRANSPOSITION_TABLE_SIZE_IN_MB))
+      : transposition_table_(std::move(transposition_table)) {}
+
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board,
+                       Color active_player) noexcept override {
+    return Explore(board, active_player, clock::time_point::max());
+  }
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                       const Deadline &deadline) noexcept override;
+
+  [[nodiscard]] const TranspositionTable &transposition_table() const noexcept {
+    return *transposition_table_;
+  }
+
+ private:
+  std::shared_ptr<TranspositionTable> transposition_table_;
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+SearchResult SolvingExplorer<HEIGHT, WIDTH, RULES>::Explore(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    const Deadline &deadline) noexcept {
+  const auto start = clock::now();
+  transposition_table_->NewSearch();
+  AlphaBetaSearch<HEIGHT, WIDTH, RULES> search(
+      this->rules_, *transposition_table_, board, active_player, deadline);
+  search.EnableFinalValuePruning();
+  search.UseTablebase(this->tablebase_.get());
+  if (this->uses_symmetric_keys_) {
+    search.EnableSymmetricKeys();
+  }
+  search.ReportProgressTo(this->progress_callback_or_null());
+  // Every move removes a tower and no player skips twice in a row, so the
+  // game ends within twice as many half-turns as there are towers.
+  // Iterating up to there still pays off as it fills the transposition table
+  // with good moves to try first.
+  const auto best_move = search.IterativelyDeepen(
+      1, static_cast<uint8_t>(
+             std::min<uint32_t>(2 * board.num_towers(), PROVEN_DEPTH - 1)));
+  return details::Summarize(search, best_move, start);
+}
 }  // namespace libsanjego
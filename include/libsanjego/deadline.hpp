@@ -0,0 +1,66 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace libsanjego {
+/*
+ * The point in time a search has to stop at. Unlike a plain time point, it
+ * can be moved while searches are running, which for example turns a search
+ * without a time limit into a timed one once it is clear how long it may
+ * take.
+ */
+class Deadline {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+  /*
+   * Creates a deadline at the given point in time, which never passes by
+   * default.
+   */
+  explicit Deadline(
+      const clock::time_point time_point = clock::time_point::max()) noexcept
+      : ticks_(time_point.time_since_epoch().count()) {}
+  Deadline(const Deadline &other) = delete;
+  Deadline &operator=(const Deadline &other) = delete;
+
+  [[nodiscard]] bool HasPassed() const noexcept {
+    return clock::now() >= time_point();
+  }
+
+  /*
+   * Searches that are running pick up the new point in time the next time
+   * they read the clock.
+   */
+  void MoveTo(const clock::time_point time_point) noexcept {
+    ticks_.store(time_point.time_since_epoch().count(),
+                 std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] clock::time_point time_point() const noexcept {
+    return clock::time_point(
+        clock::duration(ticks_.load(std::memory_order_relaxed)));
+  }
+
+ private:
+  std::atomic<clock::rep> ticks_;
+};
+}  // namespace libsanjego
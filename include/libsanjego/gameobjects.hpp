@@ -19,10 +19,13 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
 #include <optional>
+#include <span>
+#include <type_traits>
 #include <utility>
-#include <vector>
 
 #include "types.hpp"
 
@@ -33,6 +36,19 @@ enum struct Color : uint8_t { Blue = 0, Yellow = 1 };
 template <board_size_t HEIGHT, board_size_t WIDTH>
 class Board;
 
+namespace details {
+// least significant bit
+constexpr uint8_t OWNER_BIT = 1;
+constexpr tower_size_t WithoutOwner(const tower_size_t data) noexcept {
+  return data >> OWNER_BIT;
+}
+constexpr tower_size_t Pack(const tower_size_t height,
+                            const Color color) noexcept {
+  return static_cast<tower_size_t>(height << OWNER_BIT |
+                                   static_cast<uint8_t>(color));
+}
+}  // namespace details
+
 /*
  * This Tower implementation does not preserve the actual structure,
  * that is the order of bricks it consists of. It only stores its height and
@@ -43,10 +59,16 @@ class Board;
  */
 class Tower {
  public:
-  explicit Tower(Color color);
-  explicit Tower(Color color, tower_size_t height);
-  [[nodiscard]] Color top() const noexcept;
-  [[nodiscard]] tower_size_t height() const noexcept;
+  explicit constexpr Tower(const Color color)
+      : representation_(details::Pack(1, color)) {}
+  explicit constexpr Tower(const Color color, const tower_size_t height)
+      : representation_(details::Pack(height, color)) {}
+  [[nodiscard]] constexpr Color top() const noexcept {
+    return static_cast<Color>(representation_ & details::OWNER_BIT);
+  }
+  [[nodiscard]] constexpr tower_size_t height() const noexcept {
+    return details::WithoutOwner(representation_);
+  }
 
   /*
    * Adds the given tower on top of *this* one. As a result, their heights are
@@ -64,7 +86,12 @@ class Tower {
    *   // target: |BBBY
    *   ```
    */
-  void Attach(const Tower tower);
+  constexpr void Attach(const Tower tower) {
+    if (tower.IsEmpty()) {
+      return;
+    }
+    representation_ = details::Pack(height() + tower.height(), tower.top());
+  }
 
   /*
    * Removes the given tower from the bottom of *this* one. It is the inverse
@@ -86,7 +113,12 @@ class Tower {
    *   // target: |B
    *   ```
    */
-  void DetachFrom(const Tower tower);
+  constexpr void DetachFrom(const Tower tower) {
+    if (tower.height() >= height()) {
+      return;
+    }
+    representation_ = details::Pack(height() - tower.height(), top());
+  }
 
   template <board_size_t HEIGHT, board_size_t WIDTH>
   friend class Board;
@@ -96,39 +128,118 @@ class Tower {
   /*
    * Marks this tower instance as empty. This is a safe alternative to nullptr.
    */
-  void Clear() noexcept;
+  constexpr void Clear() noexcept { representation_ = 0; }
   /*
    * Returns whether this tower is actually a null value.
    */
-  [[nodiscard]] bool IsEmpty() const noexcept;
+  [[nodiscard]] constexpr bool IsEmpty() const noexcept {
+    return representation_ == 0;
+  }
+  /*
+   * Gives the top brick the other color. Does nothing to empty towers.
+   */
+  constexpr void SwapColor() noexcept {
+    if (not IsEmpty()) {
+      representation_ ^= details::OWNER_BIT;
+    }
+  }
 };
 
 struct Position {
   RowNr row;
   ColumnNr column;
 
-  bool operator==(const Position &other) const noexcept;
+  constexpr bool operator==(const Position &other) const noexcept {
+    return row == other.row && column == other.column;
+  }
 };
 
 namespace details {
-uint32_t ToArrayIndex(Position position, ColumnNr board_width);
+constexpr uint32_t ToArrayIndex(const Position position,
+                                const ColumnNr board_width) noexcept {
+  return position.row * board_width + position.column;
+}
+
+/*
+ * Creates the towers of a new board of the given size, row by row, with the
+ * colors alternating in a checkerboard-like pattern.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH, std::size_t... INDICES>
+constexpr std::array<Tower, HEIGHT * WIDTH> CheckerboardPatternOf(
+    std::index_sequence<INDICES...>) {
+  return {Tower(static_cast<Color>((INDICES / WIDTH + INDICES % WIDTH) %
+                                   2))...};
+}
+
+/*
+ * One bit per field of a board, row by row, that tells which fields hold a
+ * tower and which of these have a yellow top.
+ */
+struct Bitboards {
+  uint64_t occupied = 0;
+  uint64_t yellow = 0;
+};
+
+// takes no space in boards that are too large for bitboards
+struct NoBitboards {};
 
 /*
- * Initializes the field with height*width towers.
- * Assumes the field is empty before the operation.
+ * Wide enough to count the towers of a single height on a board with the
+ * given number of fields.
  */
-void SetCheckerboardPattern(std::vector<Tower> &field, RowNr height,
-                            ColumnNr width);
+template <uint32_t NUM_FIELDS>
+using HeightCount =
+    std::conditional_t<NUM_FIELDS <= UINT8_MAX, uint8_t, uint16_t>;
 
 /*
  * Returns whether the given position lies outside the rectangular region
  * defined by the template parameters and (0,0).
  */
 template <board_size_t HEIGHT, board_size_t WIDTH>
-bool ExceedsBorder(const Position &position) {
+constexpr bool ExceedsBorder(const Position &position) noexcept {
   return position.row < 0 || position.column < 0 || position.row >= HEIGHT ||
          position.column >= WIDTH;
 }
+
+/*
+ * Finalizer of the SplitMix64 generator. It scrambles the bits of its input
+ * such that similar inputs map to unrelated outputs.
+ */
+constexpr uint64_t Mix(uint64_t value) noexcept {
+  value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+  return value ^ (value >> 31);
+}
+
+/*
+ * Random keys per field of a board that make up its Zobrist hash.
+ * They are generated at compile time with a SplitMix64 sequence.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+constexpr auto GenerateZobristKeys() noexcept {
+  std::array<uint64_t, HEIGHT * WIDTH> keys{};
+  uint64_t state = 0x5A4E4A45474F0000ULL + HEIGHT * 256 + WIDTH;
+  for (auto &key : keys) {
+    state += 0x9E3779B97F4A7C15ULL;
+    key = Mix(state);
+  }
+  return keys;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+inline constexpr auto ZOBRIST_KEYS = GenerateZobristKeys<HEIGHT, WIDTH>();
+
+/*
+ * Returns the key of a tower with the given (owner, height) representation
+ * standing on the given field. Rather than storing a key for every possible
+ * height, the field's key is mixed with the representation, which keeps the
+ * tables small for big boards.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+constexpr uint64_t ZobristKeyOf(const uint32_t field_index,
+                                const tower_size_t representation) noexcept {
+  return Mix(ZOBRIST_KEYS<HEIGHT, WIDTH>[field_index] ^ representation);
+}
 }  // namespace details
 
 /*
@@ -160,16 +271,227 @@ inline bool WasMadeBefore(const Move &move) noexcept {
 }
 }  // namespace details
 
+/*
+ * The directions a tower can be moved in, in the order moves are generated.
+ */
+enum class Direction : uint8_t { Down, Up, Right, Left };
+
+/*
+ * A move to a neighbouring field, packed like this:
+ * [source field: bit 15..2 | direction: bit 1..0]
+ * where fields are numbered row by row. Unlike a Move, it does not carry the
+ * tower it displaces, as the board keeps that itself. Packed moves are thus
+ * never written to once created and can be shared between threads.
+ */
+class PackedMove {
+ public:
+  // boards with more fields can not pack their moves
+  static constexpr uint32_t MAX_FIELDS = (1 << 14) - 1;
+
+  PackedMove() = default;
+  constexpr PackedMove(const uint32_t source_index,
+                       const Direction direction) noexcept
+      : bits_(static_cast<uint16_t>(source_index << 2 |
+                                    static_cast<uint8_t>(direction))) {}
+
+  /*
+   * Creates a move that signals that the player wants to skip the turn.
+   */
+  static constexpr PackedMove Skip() noexcept {
+    return PackedMove(MAX_FIELDS, Direction::Left);
+  }
+  [[nodiscard]] constexpr bool IsSkip() const noexcept {
+    return *this == Skip();
+  }
+
+  [[nodiscard]] constexpr uint32_t source_index() const noexcept {
+    return bits_ >> 2;
+  }
+  [[nodiscard]] constexpr Direction direction() const noexcept {
+    return static_cast<Direction>(bits_ & 3);
+  }
+  /*
+   * Distinct for all moves on a board, and less than four times its number
+   * of fields unless the move is a skip.
+   */
+  [[nodiscard]] constexpr uint16_t bits() const noexcept { return bits_; }
+
+  constexpr bool operator==(const PackedMove &) const noexcept = default;
+
+ private:
+  // left uninitialized by default, so that arrays of moves are cheap to make
+  uint16_t bits_;
+};
+
+namespace details {
+/*
+ * Stands for the neighbour of a field at the border that lies beyond it.
+ */
+constexpr uint16_t NO_NEIGHBOUR = UINT16_MAX;
+
+/*
+ * Returns the index of the neighbour of each field in each direction, or
+ * NO_NEIGHBOUR, indexed by the bits of the packed move to it.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+constexpr std::array<uint16_t, 4 * HEIGHT * WIDTH> NeighboursOf() noexcept {
+  std::array<uint16_t, 4 * HEIGHT * WIDTH> neighbours{};
+  for (uint32_t source = 0; source < HEIGHT * WIDTH; ++source) {
+    const auto row = source / WIDTH;
+    const auto column = source % WIDTH;
+    neighbours[4 * source + static_cast<uint8_t>(Direction::Down)] =
+        row + 1 < HEIGHT ? source + WIDTH : NO_NEIGHBOUR;
+    neighbours[4 * source + static_cast<uint8_t>(Direction::Up)] =
+        row > 0 ? source - WIDTH : NO_NEIGHBOUR;
+    neighbours[4 * source + static_cast<uint8_t>(Direction::Right)] =
+        column + 1 < WIDTH ? source + 1 : NO_NEIGHBOUR;
+    neighbours[4 * source + static_cast<uint8_t>(Direction::Left)] =
+        column > 0 ? source - 1 : NO_NEIGHBOUR;
+  }
+  return neighbours;
+}
+
+// computed once per board size, so that moves need no border checks
+template <board_size_t HEIGHT, board_size_t WIDTH>
+inline constexpr auto NEIGHBOURS = NeighboursOf<HEIGHT, WIDTH>();
+
+/*
+ * Returns the index of the field a packed move stacks its tower onto, or
+ * NO_NEIGHBOUR if it would leave the board. The source has to be on the
+ * board.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+constexpr uint32_t TargetIndexOf(const PackedMove move) noexcept {
+  return NEIGHBOURS<HEIGHT, WIDTH>[move.bits()];
+}
+
+/*
+ * Returns whether both the source and the target of the packed move lie on
+ * the board. Skips never do.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+constexpr bool StaysOnBoard(const PackedMove move) noexcept {
+  return move.bits() < NEIGHBOURS<HEIGHT, WIDTH>.size() &&
+         NEIGHBOURS<HEIGHT, WIDTH>[move.bits()] != NO_NEIGHBOUR;
+}
+
+/*
+ * The board-owned record of a packed move that lets Board::Undo revert it.
+ */
+struct UndoRecord {
+  PackedMove move;
+  Tower displaced_tower{Color::Blue, 0};
+};
+}  // namespace details
+
+/*
+ * Returns the packed form of a move to a neighbouring field. Skips and
+ * moves to any other field pack into PackedMove::Skip().
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+PackedMove PackMove(const Move &move) noexcept {
+  if (details::ExceedsBorder<HEIGHT, WIDTH>(move.source) ||
+      details::ExceedsBorder<HEIGHT, WIDTH>(move.target)) {
+    return PackedMove::Skip();
+  }
+  const auto source_index = details::ToArrayIndex(move.source, WIDTH);
+  if (move.target.column == move.source.column) {
+    if (move.target.row == move.source.row + 1) {
+      return {source_index, Direction::Down};
+    }
+    if (move.target.row + 1 == move.source.row) {
+      return {source_index, Direction::Up};
+    }
+  } else if (move.target.row == move.source.row) {
+    if (move.target.column == move.source.column + 1) {
+      return {source_index, Direction::Right};
+    }
+    if (move.target.column + 1 == move.source.column) {
+      return {source_index, Direction::Left};
+    }
+  }
+  return PackedMove::Skip();
+}
+
+/*
+ * Inverse of PackMove. Moves that leave the board unpack into Move::Skip(),
+ * like skips themselves.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+Move UnpackMove(const PackedMove move) noexcept {
+  if (not details::StaysOnBoard<HEIGHT, WIDTH>(move)) {
+    return Move::Skip();
+  }
+  const auto source = move.source_index();
+  const auto target = details::TargetIndexOf<HEIGHT, WIDTH>(move);
+  return {{board_size_t(source / WIDTH), board_size_t(source % WIDTH)},
+          {board_size_t(target / WIDTH), board_size_t(target % WIDTH)}};
+}
+
+/*
+ * A list of packed moves that lives wherever it is declared, usually on the
+ * stack, instead of allocating its moves. Each field can be the source of at
+ * most four moves, so no position has more than it can hold.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+class MoveList {
+ public:
+  static constexpr uint32_t CAPACITY = 4 * HEIGHT * WIDTH;
+
+  void Add(const PackedMove move) noexcept { moves_[size_++] = move; }
+  void Clear() noexcept { size_ = 0; }
+
+  [[nodiscard]] uint32_t size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+  PackedMove &operator[](const uint32_t index) noexcept {
+    return moves_[index];
+  }
+  const PackedMove &operator[](const uint32_t index) const noexcept {
+    return moves_[index];
+  }
+  PackedMove *data() noexcept { return moves_.data(); }
+  const PackedMove *data() const noexcept { return moves_.data(); }
+  PackedMove *begin() noexcept { return data(); }
+  PackedMove *end() noexcept { return data() + size_; }
+  const PackedMove *begin() const noexcept { return data(); }
+  const PackedMove *end() const noexcept { return data() + size_; }
+
+ private:
+  // left uninitialized beyond the size
+  std::array<PackedMove, CAPACITY> moves_;
+  uint32_t size_ = 0;
+};
+
+/*
+ * Boards with at most this many fields keep bitboards of their towers, see
+ * Board::USES_BITBOARDS.
+ */
+constexpr uint32_t MAX_BITBOARD_FIELDS = 64;
+
 template <board_size_t HEIGHT, board_size_t WIDTH>
 class Board {
  public:
+  /*
+   * Small boards keep bitboards of the occupied fields and owners next to
+   * their towers, which make finding the towers of a player a matter of a
+   * few bit operations.
+   */
+  static constexpr bool USES_BITBOARDS =
+      HEIGHT * WIDTH <= MAX_BITBOARD_FIELDS;
+
   /*
    * Creates a new Board by placing towers of height 1 on the field
    * with the colors alternating in a checkerboard-like pattern.
    */
-  Board() {
-    fields_.reserve(HEIGHT * WIDTH);
-    details::SetCheckerboardPattern(fields_, HEIGHT, WIDTH);
+  constexpr Board()
+      : fields_(details::CheckerboardPatternOf<HEIGHT, WIDTH>(
+            std::make_index_sequence<HEIGHT * WIDTH>())) {
+    for (uint32_t index = 0; index < fields_.size(); ++index) {
+      hash_ ^= details::ZobristKeyOf<HEIGHT, WIDTH>(
+          index, fields_[index].representation_);
+      UpdateBitboardsAt(index);
+      CountHeightOf(fields_[index]);
+    }
   }
 
   /*
@@ -177,22 +499,55 @@ class Board {
    * actually legal (apart from bound checks).
    * Returns whether the move was carried out successfully.
    */
-  bool Make(Move &move) noexcept {
+  constexpr bool Make(Move &move) noexcept {
     if (details::ExceedsBorder<HEIGHT, WIDTH>(move.source) ||
         details::ExceedsBorder<HEIGHT, WIDTH>(move.target) ||
         move.source == move.target) {
       return false;
     }
-    auto &source_tower =
-        this->fields_[details::ToArrayIndex(move.source, width())];
-    auto &target_tower =
-        this->fields_[details::ToArrayIndex(move.target, width())];
-    move.affected_tower = target_tower;
-    target_tower.Attach(source_tower);
-    source_tower.Clear();
+    const auto target_index = details::ToArrayIndex(move.target, width());
+    move.affected_tower = fields_[target_index];
+    Stack(details::ToArrayIndex(move.source, width()), target_index);
+    return true;
+  }
+
+  /*
+   * Makes the packed move on this board and keeps the tower it displaces, so
+   * that Undo() can revert it later. Like Make(Move&), it does not check
+   * whether the move is legal apart from bound checks, and skips are not
+   * made.
+   * Returns whether the move was carried out successfully.
+   */
+  constexpr bool Make(const PackedMove move) noexcept {
+    static_assert(HEIGHT * WIDTH <= PackedMove::MAX_FIELDS,
+                  "moves on this board can not be packed");
+    if (not details::StaysOnBoard<HEIGHT, WIDTH>(move) ||
+        num_undo_records_ == undo_records_.size()) {
+      return false;
+    }
+    const auto target_index = details::TargetIndexOf<HEIGHT, WIDTH>(move);
+    undo_records_[num_undo_records_++] = {move, fields_[target_index]};
+    Stack(move.source_index(), target_index);
+    return true;
+  }
+
+  /*
+   * Reverts the last move made with Make(PackedMove) and returns whether
+   * there was one. Moves made with Make(Move&) are not tracked by the board
+   * and must be reverted with Undo(Move&) instead.
+   */
+  constexpr bool Undo() noexcept {
+    if (num_undo_records_ == 0) {
+      return false;
+    }
+    const auto &record = undo_records_[--num_undo_records_];
+    Unstack(record.move.source_index(),
+            details::TargetIndexOf<HEIGHT, WIDTH>(record.move),
+            record.displaced_tower);
     return true;
   }
 
+
   /*
    * Reverts a move previously made on this board and returns whether this
    * was successful.
@@ -201,7 +556,7 @@ class Board {
    * or the source position of the move is not empty, indicating that the move
    * has not been done on *this* board before.
    */
-  bool Undo(Move &move) noexcept {
+  constexpr bool Undo(Move &move) noexcept {
     if (details::ExceedsBorder<HEIGHT, WIDTH>(move.source) ||
         details::ExceedsBorder<HEIGHT, WIDTH>(move.target) ||
         move.source == move.target) {
@@ -212,18 +567,12 @@ class Board {
       return false;
     }
 
-    auto &source_tower =
-        this->fields_[details::ToArrayIndex(move.source, width())];
-    if (not source_tower.IsEmpty()) {
+    const auto source_index = details::ToArrayIndex(move.source, width());
+    if (not fields_[source_index].IsEmpty()) {
       return false;
     }
-    auto &target_tower =
-        this->fields_[details::ToArrayIndex(move.target, width())];
-
-    std::swap(source_tower, target_tower);
-    target_tower = move.affected_tower.value();
-    source_tower.DetachFrom(target_tower);
-
+    Unstack(source_index, details::ToArrayIndex(move.target, width()),
+            move.affected_tower.value());
     return true;
   }
 
@@ -231,7 +580,7 @@ class Board {
    * Returns a copy of the tower at the given position for read-only tasks if
    * the board has a tower at the specified position.
    */
-  [[nodiscard]] std::optional<Tower> GetTowerAt(
+  [[nodiscard]] constexpr std::optional<Tower> GetTowerAt(
       Position position) const noexcept {
     if (details::ExceedsBorder<HEIGHT, WIDTH>(position)) {
       return {};
@@ -244,30 +593,233 @@ class Board {
   }
 
   /*
-   * Computes the height of the highest tower that is owned by the player with
+   * Returns the height of the highest tower that is owned by the player with
    * the given color.
    * If there is no tower with the given owner on the board, 0 is returned.
+   * The heights are tracked by Make and Undo, so this takes constant time.
+   */
+  [[nodiscard]] constexpr tower_size_t MaxHeightOf(
+      const Color owner) const noexcept {
+    return max_heights_[static_cast<uint8_t>(owner)];
+  }
+
+  /*
+   * Returns the height of the highest tower the given player is left with
+   * if they lose one of their highest towers. This equals MaxHeightOf if
+   * they have several towers of that height.
+   */
+  [[nodiscard]] constexpr tower_size_t RunnerUpHeightOf(
+      const Color owner) const noexcept {
+    const auto &counts = height_counts_[static_cast<uint8_t>(owner)];
+    auto height = MaxHeightOf(owner);
+    if (height == 0 || counts[height] > 1) {
+      return height;
+    }
+    while (--height > 0 && counts[height] == 0) {
+    }
+    return height;
+  }
+
+  /*
+   * Returns a copy of this board with the tower on each field moved to the
+   * field given by the permutation at its index, where fields are numbered
+   * row by row. If swaps_colors is set, all towers change their color, too.
    */
-  [[nodiscard]] tower_size_t MaxHeightOf(const Color owner) const noexcept {
-    tower_size_t max_height = 0;
-    for (const Tower &tower : fields_) {
-      if (tower.top() == owner) {
-        max_height = std::max(max_height, tower.height());
+  template <typename PERMUTATION>
+  [[nodiscard]] constexpr Board Permuted(
+      const PERMUTATION &field_permutation,
+      const bool swaps_colors) const noexcept {
+    Board permuted = *this;
+    permuted.hash_ = 0;
+    for (uint32_t index = 0; index < fields_.size(); ++index) {
+      auto tower = fields_[index];
+      if (swaps_colors) {
+        tower.SwapColor();
+      }
+      const auto target_index = field_permutation[index];
+      permuted.fields_[target_index] = tower;
+      if (not tower.IsEmpty()) {
+        permuted.hash_ ^= details::ZobristKeyOf<HEIGHT, WIDTH>(
+            target_index, tower.representation_);
       }
     }
-    return max_height;
+    for (uint32_t index = 0; index < fields_.size(); ++index) {
+      permuted.UpdateBitboardsAt(index);
+    }
+    if (swaps_colors) {
+      std::swap(permuted.height_counts_[0], permuted.height_counts_[1]);
+      std::swap(permuted.max_heights_[0], permuted.max_heights_[1]);
+    }
+    return permuted;
+  }
+
+  /*
+   * Read-only access to all fields row by row. Empty fields hold towers of
+   * height 0.
+   */
+  [[nodiscard]] constexpr std::span<const Tower> fields() const noexcept {
+    return fields_;
+  }
+
+  /*
+   * The fields that hold a tower, with bit i standing for field i row by row.
+   */
+  [[nodiscard]] constexpr uint64_t occupied() const noexcept
+    requires USES_BITBOARDS
+  {
+    return bitboards_.occupied;
+  }
+
+  /*
+   * The fields that hold a tower with a top brick of the given color, with
+   * bit i standing for field i row by row.
+   */
+  [[nodiscard]] constexpr uint64_t OwnedBy(const Color owner) const noexcept
+    requires USES_BITBOARDS
+  {
+    return owner == Color::Yellow ? bitboards_.yellow
+                                  : bitboards_.occupied & ~bitboards_.yellow;
   }
 
   [[nodiscard]] constexpr RowNr height() const noexcept { return HEIGHT; }
   [[nodiscard]] constexpr ColumnNr width() const noexcept { return WIDTH; }
 
+  /*
+   * Returns a Zobrist hash of the towers on this board. It is maintained
+   * incrementally by Make and Undo, hence equal positions have equal hashes
+   * regardless of the moves that led to them.
+   */
+  [[nodiscard]] constexpr uint64_t hash() const noexcept { return hash_; }
+
+  /*
+   * Returns the number of towers left on this board. As every move stacks
+   * two towers, it decreases by one with each move.
+   */
+  [[nodiscard]] constexpr uint32_t num_towers() const noexcept {
+    return num_towers_;
+  }
+
  private:
-  std::vector<Tower> fields_;
+  // kept in place, so that copying a board is as cheap as copying its bytes
+  std::array<Tower, HEIGHT * WIDTH> fields_;
+  [[no_unique_address]] std::conditional_t<
+      USES_BITBOARDS, details::Bitboards, details::NoBitboards>
+      bitboards_;
+  // number of towers of each height per owner, indexed by color and height
+  std::array<std::array<details::HeightCount<HEIGHT * WIDTH>,
+                        HEIGHT * WIDTH + 1>,
+             2>
+      height_counts_{};
+  std::array<tower_size_t, 2> max_heights_{};
+  // one record per packed move that has not been undone yet; every move
+  // removes a tower, so they can not outnumber the fields
+  std::array<details::UndoRecord, HEIGHT * WIDTH> undo_records_{};
+  uint32_t num_undo_records_ = 0;
+  uint64_t hash_ = 0;
+  uint32_t num_towers_ = HEIGHT * WIDTH;
+
+  /*
+   * Stacks the tower on the source field onto the one on the target field.
+   */
+  constexpr void Stack(const uint32_t source_index,
+                       const uint32_t target_index) noexcept {
+    auto &source_tower = fields_[source_index];
+    auto &target_tower = fields_[target_index];
+    UncountHeightOf(source_tower);
+    UncountHeightOf(target_tower);
+    hash_ ^= details::ZobristKeyOf<HEIGHT, WIDTH>(
+                 source_index, source_tower.representation_) ^
+             details::ZobristKeyOf<HEIGHT, WIDTH>(
+                 target_index, target_tower.representation_);
+    target_tower.Attach(source_tower);
+    source_tower.Clear();
+    CountHeightOf(target_tower);
+    hash_ ^= details::ZobristKeyOf<HEIGHT, WIDTH>(
+        target_index, target_tower.representation_);
+    UpdateBitboardsAt(source_index);
+    UpdateBitboardsAt(target_index);
+    --num_towers_;
+  }
+
+  /*
+   * Inverse of Stack, given the tower that was on the target field before.
+   */
+  constexpr void Unstack(const uint32_t source_index,
+                         const uint32_t target_index,
+                         const Tower displaced_tower) noexcept {
+    auto &source_tower = fields_[source_index];
+    auto &target_tower = fields_[target_index];
+    hash_ ^= details::ZobristKeyOf<HEIGHT, WIDTH>(
+        target_index, target_tower.representation_);
+    UncountHeightOf(target_tower);
+    std::swap(source_tower, target_tower);
+    target_tower = displaced_tower;
+    source_tower.DetachFrom(target_tower);
+    CountHeightOf(source_tower);
+    CountHeightOf(target_tower);
+    hash_ ^= details::ZobristKeyOf<HEIGHT, WIDTH>(
+                 source_index, source_tower.representation_) ^
+             details::ZobristKeyOf<HEIGHT, WIDTH>(
+                 target_index, target_tower.representation_);
+    UpdateBitboardsAt(source_index);
+    UpdateBitboardsAt(target_index);
+    ++num_towers_;
+  }
+
+  /*
+   * Brings the bitboards up to date with the tower on the given field.
+   */
+  constexpr void UpdateBitboardsAt(const uint32_t index) noexcept {
+    if constexpr (USES_BITBOARDS) {
+      const auto bit = uint64_t{1} << index;
+      const auto &tower = fields_[index];
+      bitboards_.occupied &= ~bit;
+      bitboards_.yellow &= ~bit;
+      if (not tower.IsEmpty()) {
+        bitboards_.occupied |= bit;
+        if (tower.top() == Color::Yellow) {
+          bitboards_.yellow |= bit;
+        }
+      }
+    }
+  }
+
+  /*
+   * Adds the given tower to the height counts of its owner.
+   */
+  constexpr void CountHeightOf(const Tower tower) noexcept {
+    if (tower.IsEmpty()) {
+      return;
+    }
+    const auto owner = static_cast<uint8_t>(tower.top());
+    const auto height = tower.height();
+    ++height_counts_[owner][height];
+    max_heights_[owner] = std::max(max_heights_[owner], height);
+  }
+
+  /*
+   * Removes the given tower from the height counts of its owner. If it was
+   * the last of the highest towers, the maximum moves down to the next
+   * height that is still counted.
+   */
+  constexpr void UncountHeightOf(const Tower tower) noexcept {
+    if (tower.IsEmpty()) {
+      return;
+    }
+    const auto owner = static_cast<uint8_t>(tower.top());
+    auto &counts = height_counts_[owner];
+    auto &max_height = max_heights_[owner];
+    --counts[tower.height()];
+    while (max_height > 0 && counts[max_height] == 0) {
+      --max_height;
+    }
+  }
 };
 
 /*
  * Factory function for Boards that chooses the most efficient
- * implementation for the given width and height.
+ * implementation for the given width and height. Boards of at most
+ * MAX_BITBOARD_FIELDS fields are backed by bitboards.
  */
 template <board_size_t HEIGHT, board_size_t WIDTH>
 Board<HEIGHT, WIDTH> CreateBoard() {
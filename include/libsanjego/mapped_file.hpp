@@ -0,0 +1,56 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace libsanjego {
+/*
+ * A read-only view of a whole file that the operating system maps into
+ * memory. Pages are only loaded when they are accessed and are shared
+ * between all processes mapping the same file.
+ */
+class MappedFile {
+ public:
+  /*
+   * Maps the file at the given path, or returns nothing if it can not be
+   * opened or is empty.
+   */
+  static std::optional<MappedFile> Open(const std::string &path) noexcept;
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+  ~MappedFile();
+
+  [[nodiscard]] const std::byte *data() const noexcept { return data_; }
+  [[nodiscard]] std::size_t size() const noexcept { return size_; }
+
+ private:
+  MappedFile(const std::byte *data, std::size_t size) noexcept
+      : data_(data), size_(size) {}
+  void Unmap() noexcept;
+
+  const std::byte *data_;
+  std::size_t size_;
+};
+}  // namespace libsanjego
@@ -0,0 +1,807 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "libsanjego/bot.hpp"
+#include "libsanjego/deadline.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/search.hpp"
+#include "libsanjego/types.hpp"
+
+namespace libsanjego {
+/*
+ * Number of playouts an MctsExplorer runs unless it is given a deadline.
+ */
+constexpr uint64_t DEFAULT_NUM_PLAYOUTS = 10000;
+
+/*
+ * Memory an MctsExplorer reserves for its tree unless told otherwise.
+ */
+constexpr std::size_t DEFAULT_MCTS_TREE_SIZE_IN_MB = 64;
+
+/*
+ * Weight of the exploration term in the UCT formula. Larger values make the
+ * search try rarely visited moves more often.
+ */
+constexpr double UCT_EXPLORATION = 1.4;
+
+/*
+ * Number of half-turns below the previous root within which an MctsSearch
+ * looks for the next root to keep its subtree. Two covers the own move and
+ * the opponent's reply.
+ */
+constexpr uint8_t MAX_REUSED_PLIES = 2;
+
+/*
+ * A pool of nodes that hands out consecutive blocks of them, also to several
+ * threads at once. It never frees single nodes, but can be emptied at once,
+ * which makes discarding a whole tree as cheap as resetting a counter.
+ * NODE must be trivially destructible, as nodes are overwritten without
+ * being destroyed.
+ */
+template <typename NODE>
+class NodeArena {
+ public:
+  explicit NodeArena(std::size_t capacity)
+      : capacity_(std::max<std::size_t>(capacity, 1)),
+        // left uninitialized so that untouched pages are never committed
+        nodes_(new NODE[capacity_]) {}
+
+  /*
+   * Returns the index of the first of num_nodes uninitialized consecutive
+   * nodes, or nothing if the arena is full.
+   */
+  std::optional<uint32_t> Allocate(const uint32_t num_nodes) noexcept {
+    const auto first = size_.fetch_add(num_nodes, std::memory_order_relaxed);
+    if (first + num_nodes > capacity_) {
+      // blocks are never returned, so the arena stays full from now on
+      return {};
+    }
+    return static_cast<uint32_t>(first);
+  }
+
+  /*
+   * Must not be called while other threads use the arena.
+   */
+  void Clear() noexcept { size_.store(0, std::memory_order_relaxed); }
+
+  NODE &operator[](const uint32_t index) noexcept { return nodes_[index]; }
+  const NODE &operator[](const uint32_t index) const noexcept {
+    return nodes_[index];
+  }
+  [[nodiscard]] bool IsFull() const noexcept {
+    return size_.load(std::memory_order_relaxed) >= capacity_;
+  }
+  // number of nodes handed out
+  [[nodiscard]] std::size_t size() const noexcept {
+    return std::min(size_.load(std::memory_order_relaxed), capacity_);
+  }
+  [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+
+ private:
+  std::size_t capacity_;
+  std::unique_ptr<NODE[]> nodes_;
+  std::atomic<std::size_t> size_ = 0;
+};
+
+namespace details {
+enum struct NodeState : uint8_t { Unexpanded, Expanding, Expanded, Terminal };
+
+/*
+ * A node of a Monte-Carlo search tree. It represents the position after the
+ * move leading to it, and its statistics are kept from the point of view of
+ * the player who made that move.
+ * Fields that change after a node was published are only accessed through
+ * std::atomic_ref, which keeps the node trivial so that arenas do not need to
+ * initialize it.
+ */
+struct MctsNode {
+  // only valid once the node is expanded
+  uint32_t first_child;
+  uint32_t visits;
+  float reward_sum;
+  uint16_t num_children;
+  // the move leading here, which is a skip for the root
+  PackedMove move;
+  NodeState state;
+};
+
+/*
+ * Returns the reward of a finished game with the given value, from the first
+ * player's point of view: 1 for a win, 0.5 for a draw and 0 for a loss.
+ */
+inline float RewardOf(const game_value_t value) noexcept {
+  return value > 0 ? 1.0f : value < 0 ? 0.0f : 0.5f;
+}
+}  // namespace details
+
+/*
+ * A Monte-Carlo tree search of a single position. It repeatedly descends the
+ * tree built so far, choosing moves with the UCT formula, adds the children
+ * of the node it ends up at and plays the game to its end with random moves.
+ * The results of these playouts guide later descents towards promising
+ * moves.
+ *
+ * Several threads may run playouts on the same tree at once. Each descent
+ * counts its visits right away, before the playout result is known, which
+ * acts as a virtual loss that steers other threads to different lines.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class MctsSearch {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+  explicit MctsSearch(std::size_t tree_size_in_mb)
+      : arena_(tree_size_in_mb * 1024 * 1024 / sizeof(details::MctsNode)) {}
+
+  /*
+   * Discards the previous tree and starts a new one for the given position.
+   */
+  void Reset(const Board<HEIGHT, WIDTH> &board, Color active_player) noexcept;
+
+  /*
+   * Makes the given position the new root. If it is in the tree within
+   * MAX_REUSED_PLIES half-turns below the previous root, its subtree and
+   * statistics are kept, otherwise the tree is reset.
+   * Returns whether the subtree was kept.
+   */
+  bool MoveRootTo(const Board<HEIGHT, WIDTH> &board,
+                  Color active_player) noexcept;
+
+  /*
+   * Runs playouts until the deadline has passed or max_playouts playouts
+   * have been started, counting those of all threads that share the counter
+   * of started playouts. Returns the number of playouts this call ran.
+   */
+  uint64_t RunPlayouts(const RULES &rules, uint64_t seed,
+                       const Deadline &deadline, uint64_t max_playouts,
+                       std::atomic<uint64_t> &num_started_playouts) noexcept;
+
+  /*
+   * Returns the moves of the root in the order they were generated along
+   * with how often they were visited, or nothing if the root is not expanded.
+   * Must not be called while playouts are running.
+   */
+  [[nodiscard]] std::vector<std::pair<Move, uint64_t>> RootVisits()
+      const noexcept;
+
+  /*
+   * Returns the line of play that starts with the given root move and
+   * continues with the most visited moves.
+   * Must not be called while playouts are running.
+   */
+  [[nodiscard]] std::vector<Move> PrincipalVariation(
+      const Move &first_move) const noexcept;
+
+  [[nodiscard]] uint8_t max_explored_depth() const noexcept {
+    return max_explored_depth_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  NodeArena<details::MctsNode> arena_;
+  uint32_t root_ = 0;
+  Board<HEIGHT, WIDTH> root_board_;
+  Color root_player_ = Color::Blue;
+  std::atomic<uint8_t> max_explored_depth_ = 0;
+
+  // what each thread needs for its playouts
+  struct Context {
+    const RULES &rules;
+    Board<HEIGHT, WIDTH> board;
+    details::Xorshift random;
+    std::vector<uint32_t> path;
+    // moves made on the board since the root, which it keeps for undoing
+    uint32_t num_made_moves;
+    uint8_t max_explored_depth;
+  };
+
+  void RunPlayout(Context &context) noexcept;
+
+  /*
+   * Returns the node of the given position at most depth_left half-turns
+   * below the given node, whose position is node_board with node_player to
+   * move. Positions are told apart by their hashes only.
+   */
+  std::optional<uint32_t> FindNode(uint32_t node,
+                                   Board<HEIGHT, WIDTH> node_board,
+                                   Color node_player,
+                                   const Board<HEIGHT, WIDTH> &board,
+                                   Color active_player,
+                                   uint8_t depth_left) const noexcept;
+
+  /*
+   * Adds all children of the given node unless another thread is doing so
+   * already or the arena is full.
+   */
+  void Expand(uint32_t node, Context &context, Color active_player) noexcept;
+
+  /*
+   * Picks the child with the best UCT score and counts a visit of it.
+   * Returns it along with whether it had not been visited before.
+   */
+  std::pair<uint32_t, bool> VisitBestChild(uint32_t node) noexcept;
+
+  /*
+   * Makes random moves until the game is over and returns its final value.
+   */
+  game_value_t Rollout(Context &context, Color active_player) noexcept;
+
+  static Move MoveOf(const details::MctsNode &node) noexcept {
+    return UnpackMove<HEIGHT, WIDTH>(node.move);
+  }
+
+  details::NodeState StateOf(const uint32_t node) noexcept {
+    return std::atomic_ref(arena_[node].state).load(std::memory_order_acquire);
+  }
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+void MctsSearch<HEIGHT, WIDTH, RULES>::Reset(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player) noexcept {
+  arena_.Clear();
+  root_ = arena_.Allocate(1).value();
+  arena_[root_] = {
+      0, 0, 0.0f, 0, PackedMove::Skip(), details::NodeState::Unexpanded};
+  root_board_ = board;
+  root_player_ = active_player;
+  max_explored_depth_.store(0, std::memory_order_relaxed);
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+bool MctsSearch<HEIGHT, WIDTH, RULES>::MoveRootTo(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player) noexcept {
+  // A tree that takes more than half of the arena would leave the new root
+  // too little room to grow.
+  if (arena_.size() > 0 && arena_.size() <= arena_.capacity() / 2) {
+    const auto node = FindNode(root_, root_board_, root_player_, board,
+                               active_player, MAX_REUSED_PLIES);
+    if (node.has_value()) {
+      root_ = node.value();
+      root_board_ = board;
+      root_player_ = active_player;
+      max_explored_depth_.store(0, std::memory_order_relaxed);
+      return true;
+    }
+  }
+  Reset(board, active_player);
+  return false;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+std::optional<uint32_t> MctsSearch<HEIGHT, WIDTH, RULES>::FindNode(
+    const uint32_t node, Board<HEIGHT, WIDTH> node_board,
+    const Color node_player, const Board<HEIGHT, WIDTH> &board,
+    const Color active_player, const uint8_t depth_left) const noexcept {
+  if (node_player == active_player && node_board.hash() == board.hash()) {
+    return node;
+  }
+  const auto &parent = arena_[node];
+  if (depth_left == 0 || parent.state != details::NodeState::Expanded) {
+    return {};
+  }
+  for (uint32_t child = parent.first_child;
+       child < parent.first_child + parent.num_children; ++child) {
+    const auto move = arena_[child].move;
+    if (not move.IsSkip()) {
+      node_board.Make(move);
+    }
+    const auto found =
+        FindNode(child, node_board, details::OpponentOf(node_player), board,
+                 active_player, depth_left - 1);
+    if (not move.IsSkip()) {
+      node_board.Undo();
+    }
+    if (found.has_value()) {
+      return found;
+    }
+  }
+  return {};
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+uint64_t MctsSearch<HEIGHT, WIDTH, RULES>::RunPlayouts(
+    const RULES &rules, const uint64_t seed, const Deadline &deadline,
+    const uint64_t max_playouts,
+    std::atomic<uint64_t> &num_started_playouts) noexcept {
+  Context context{rules, root_board_, details::Xorshift(seed), {}, 0, 0};
+  uint64_t num_playouts = 0;
+  // a playout takes long enough to read the clock before each one
+  while ((num_playouts == 0 || not deadline.HasPassed()) &&
+         num_started_playouts.fetch_add(1, std::memory_order_relaxed) <
+             max_playouts) {
+    RunPlayout(context);
+    ++num_playouts;
+  }
+
+  auto max_depth = max_explored_depth_.load(std::memory_order_relaxed);
+  while (context.max_explored_depth > max_depth &&
+         not max_explored_depth_.compare_exchange_weak(
+             max_depth, context.max_explored_depth,
+             std::memory_order_relaxed)) {
+  }
+  return num_playouts;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+void MctsSearch<HEIGHT, WIDTH, RULES>::RunPlayout(Context &context) noexcept {
+  context.path.clear();
+  context.num_made_moves = 0;
+
+  // selection
+  auto node = root_;
+  auto player = root_player_;
+  context.path.push_back(node);
+  auto is_new = std::atomic_ref(arena_[root_].visits)
+                    .fetch_add(1, std::memory_order_relaxed) == 0;
+  while (true) {
+    if (StateOf(node) == details::NodeState::Unexpanded &&
+        (node == root_ || not is_new)) {
+      Expand(node, context, player);
+    }
+    if (StateOf(node) != details::NodeState::Expanded) {
+      break;
+    }
+    std::tie(node, is_new) = VisitBestChild(node);
+    if (not arena_[node].move.IsSkip()) {
+      context.board.Make(arena_[node].move);
+      ++context.num_made_moves;
+    }
+    player = details::OpponentOf(player);
+    context.path.push_back(node);
+    if (is_new) {
+      break;
+    }
+  }
+  context.max_explored_depth =
+      std::max<uint8_t>(context.max_explored_depth,
+                        static_cast<uint8_t>(context.path.size() - 1));
+
+  // simulation
+  const auto reward = details::RewardOf(Rollout(context, player));
+  for (; context.num_made_moves > 0; --context.num_made_moves) {
+    context.board.Undo();
+  }
+
+  // backpropagation, where the root counts as reached by the opponent; the
+  // visits were counted on the way down
+  auto mover = details::OpponentOf(root_player_);
+  for (const auto index : context.path) {
+    std::atomic_ref(arena_[index].reward_sum)
+        .fetch_add(mover == Color::Blue ? reward : 1.0f - reward,
+                   std::memory_order_relaxed);
+    mover = details::OpponentOf(mover);
+  }
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+void MctsSearch<HEIGHT, WIDTH, RULES>::Expand(
+    const uint32_t node, Context &context, const Color active_player) noexcept {
+  if (arena_.IsFull()) {
+    return;
+  }
+  auto expected = details::NodeState::Unexpanded;
+  std::atomic_ref state(arena_[node].state);
+  if (not state.compare_exchange_strong(expected,
+                                        details::NodeState::Expanding,
+                                        std::memory_order_acquire)) {
+    return;
+  }
+
+  MoveList<HEIGHT, WIDTH> moves;
+  context.rules.GenerateLegalMoves(context.board, active_player, moves);
+  if (moves.empty()) {
+    if (not context.rules.HasLegalMoves(context.board,
+                                        details::OpponentOf(active_player))) {
+      state.store(details::NodeState::Terminal, std::memory_order_release);
+      return;
+    }
+    // a player without legal moves has to skip the turn
+    moves.Add(PackedMove::Skip());
+  }
+  const auto first_child =
+      arena_.Allocate(static_cast<uint32_t>(moves.size()));
+  if (not first_child.has_value()) {
+    state.store(details::NodeState::Unexpanded, std::memory_order_release);
+    return;
+  }
+  for (std::size_t index = 0; index < moves.size(); ++index) {
+    arena_[first_child.value() + index] = {
+        0, 0, 0.0f, 0, moves[index], details::NodeState::Unexpanded};
+  }
+  arena_[node].first_child = first_child.value();
+  arena_[node].num_children = static_cast<uint16_t>(moves.size());
+  // publishes the children
+  state.store(details::NodeState::Expanded, std::memory_order_release);
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+std::pair<uint32_t, bool> MctsSearch<HEIGHT, WIDTH, RULES>::VisitBestChild(
+    const uint32_t node) noexcept {
+  const auto &parent = arena_[node];
+  const auto parent_visits =
+      std::atomic_ref(arena_[node].visits).load(std::memory_order_relaxed);
+  const auto log_visits = std::log(static_cast<double>(parent_visits) + 1.0);
+  auto best_child = parent.first_child;
+  auto best_score = -1.0;
+  for (uint32_t child = parent.first_child;
+       child < parent.first_child + parent.num_children; ++child) {
+    const auto visits =
+        std::atomic_ref(arena_[child].visits).load(std::memory_order_relaxed);
+    if (visits == 0) {
+      // unvisited moves are tried first, in order
+      best_child = child;
+      break;
+    }
+    const auto reward_sum = std::atomic_ref(arena_[child].reward_sum)
+                                .load(std::memory_order_relaxed);
+    const auto score =
+        reward_sum / visits +
+        UCT_EXPLORATION * std::sqrt(log_visits / static_cast<double>(visits));
+    if (score > best_score) {
+      best_score = score;
+      best_child = child;
+    }
+  }
+  const auto previous_visits = std::atomic_ref(arena_[best_child].visits)
+                                   .fetch_add(1, std::memory_order_relaxed);
+  return {best_child, previous_visits == 0};
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+game_value_t MctsSearch<HEIGHT, WIDTH, RULES>::Rollout(
+    Context &context, Color active_player) noexcept {
+  int num_skips = 0;
+  MoveList<HEIGHT, WIDTH> moves;
+  while (num_skips < 2) {
+    moves.Clear();
+    context.rules.GenerateLegalMoves(context.board, active_player, moves);
+    if (moves.empty()) {
+      ++num_skips;
+    } else {
+      num_skips = 0;
+      context.board.Make(moves[context.random() % moves.size()]);
+      ++context.num_made_moves;
+    }
+    active_player = details::OpponentOf(active_player);
+  }
+  return context.rules.ComputeValueOf(context.board);
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+std::vector<std::pair<Move, uint64_t>>
+MctsSearch<HEIGHT, WIDTH, RULES>::RootVisits() const noexcept {
+  std::vector<std::pair<Move, uint64_t>> visits;
+  const auto &root = arena_[root_];
+  if (root.state != details::NodeState::Expanded) {
+    return visits;
+  }
+  for (uint32_t child = root.first_child;
+       child < root.first_child + root.num_children; ++child) {
+    visits.emplace_back(MoveOf(arena_[child]), arena_[child].visits);
+  }
+  return visits;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+std::vector<Move> MctsSearch<HEIGHT, WIDTH, RULES>::PrincipalVariation(
+    const Move &first_move) const noexcept {
+  std::vector<Move> variation{first_move};
+  const auto &root = arena_[root_];
+  if (root.state != details::NodeState::Expanded) {
+    return variation;
+  }
+  auto node = root.first_child;
+  while (node < root.first_child + root.num_children &&
+         not(MoveOf(arena_[node]) == first_move)) {
+    ++node;
+  }
+  if (node == root.first_child + root.num_children) {
+    return variation;
+  }
+  while (arena_[node].state == details::NodeState::Expanded) {
+    const auto &parent = arena_[node];
+    auto best_child = parent.first_child;
+    for (uint32_t child = parent.first_child + 1;
+         child < parent.first_child + parent.num_children; ++child) {
+      if (arena_[child].visits > arena_[best_child].visits) {
+        best_child = child;
+      }
+    }
+    if (arena_[best_child].visits == 0) {
+      break;
+    }
+    variation.push_back(MoveOf(arena_[best_child]));
+    node = best_child;
+  }
+  return variation;
+}
+
+namespace details {
+/*
+ * Returns the most visited move, which is the most robust choice, or the
+ * first legal move if there are no visits at all.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+Move MostVisitedMove(const std::vector<std::pair<Move, uint64_t>> &visits,
+                     const RULES &rules,
+                     const Board<HEIGHT, WIDTH> &board,
+                     const Color active_player) noexcept {
+  if (visits.empty()) {
+    // a terminal root or a tree too small for the root's children
+    const auto moves = rules.GetLegalMoves(board, active_player);
+    return moves.empty() ? Move::Skip() : moves.front();
+  }
+  const auto best = std::max_element(
+      visits.begin(), visits.end(), [](const auto &lhs, const auto &rhs) {
+        return lhs.second < rhs.second;
+      });
+  return best->first;
+}
+}  // namespace details
+
+/*
+ * Explores the game tree with a single-threaded Monte-Carlo tree search.
+ *
+ * Its quality scales with the number of playouts rather than with the
+ * search depth, which suits big boards where alpha-beta searches can not look
+ * far ahead. Without a deadline, it runs a fixed number of playouts.
+ * The number of explored nodes in its results is the number of playouts.
+ * Each search keeps the subtree of its position from the previous search if
+ * it was reached there, see MctsSearch::MoveRootTo.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class MctsExplorer : public Explorer<HEIGHT, WIDTH, RULES> {
+ public:
+  typedef typename Explorer<HEIGHT, WIDTH, RULES>::clock clock;
+  using Explorer<HEIGHT, WIDTH, RULES>::Explore;
+
+  explicit MctsExplorer(
+      uint64_t num_playouts = DEFAULT_NUM_PLAYOUTS,
+      std::size_t tree_size_in_mb = DEFAULT_MCTS_TREE_SIZE_IN_MB,
+      uint64_t seed = 1)
+      : num_playouts_(std::max<uint64_t>(num_playouts, 1)),
+        seed_(seed),
+        search_(tree_size_in_mb) {}
+
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board,
+                       Color active_player) noexcept override {
+    const Deadline deadline;
+    return Search(board, active_player, deadline, num_playouts_);
+  }
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                       const Deadline &deadline) noexcept override {
+    return Search(board, active_player, deadline,
+                  std::numeric_limits<uint64_t>::max());
+  }
+
+ private:
+  uint64_t num_playouts_;
+  uint64_t seed_;
+  MctsSearch<HEIGHT, WIDTH, RULES> search_;
+
+  SearchResult Search(const Board<HEIGHT, WIDTH> &board,
+                      const Color active_player,
+                      const Deadline &deadline,
+                      const uint64_t max_playouts) noexcept {
+    const auto start = clock::now();
+    search_.MoveRootTo(board, active_player);
+    std::atomic<uint64_t> num_started_playouts = 0;
+    const auto num_playouts =
+        search_.RunPlayouts(this->rules_, seed_, deadline, max_playouts,
+                            num_started_playouts);
+    const auto best_move = details::MostVisitedMove(
+        search_.RootVisits(), this->rules_, board, active_player);
+    auto principal_variation = search_.PrincipalVariation(best_move);
+    if (this->progress_callback_) {
+      this->progress_callback_(details::ProgressOf(
+          search_.max_explored_depth(), {}, principal_variation, num_playouts,
+          start));
+    }
+    const std::chrono::duration<double> seconds_spent = clock::now() - start;
+    return SearchResult{
+        .num_explored_nodes = num_playouts,
+        .seconds_spent = seconds_spent.count(),
+        .best_move = best_move,
+        .max_explored_depth = search_.max_explored_depth(),
+        .winner = {},
+        .proven_value = {},
+        .principal_variation = std::move(principal_variation),
+    };
+  }
+};
+
+enum struct MctsParallelism {
+  // all threads grow the same tree
+  Tree,
+  // each thread grows a tree of its own, and they are merged at the root
+  Root,
+};
+
+/*
+ * Explores the game tree with a Monte-Carlo tree search on several threads.
+ *
+ * With tree parallelism, the threads share one tree, which they keep apart
+ * from each other with virtual losses. With root parallelism, each thread
+ * searches a tree of its own with a share of the memory, and the moves are
+ * chosen by their visits summed over all trees. The latter needs no
+ * synchronization at all, but the trees do not learn from each other.
+ *
+ * The number of explored nodes in its results is the number of playouts of
+ * all threads combined.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class ParallelMctsExplorer : public Explorer<HEIGHT, WIDTH, RULES> {
+ public:
+  typedef typename Explorer<HEIGHT, WIDTH, RULES>::clock clock;
+  using Explorer<HEIGHT, WIDTH, RULES>::Explore;
+
+  /*
+   * Creates an explorer that uses the given number of threads, or one per
+   * hardware thread if it is 0. Without a deadline, the threads run
+   * num_playouts playouts in total.
+   */
+  explicit ParallelMctsExplorer(
+      MctsParallelism parallelism = MctsParallelism::Tree,
+      unsigned int num_threads = 0,
+      uint64_t num_playouts = DEFAULT_NUM_PLAYOUTS,
+      std::size_t tree_size_in_mb = DEFAULT_MCTS_TREE_SIZE_IN_MB,
+      uint64_t seed = 1);
+
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board,
+                       Color active_player) noexcept override {
+    const Deadline deadline;
+    return ExploreInParallel(board, active_player, deadline, num_playouts_);
+  }
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                       const Deadline &deadline) noexcept override {
+    return ExploreInParallel(board, active_player, deadline,
+                             std::numeric_limits<uint64_t>::max());
+  }
+
+  [[nodiscard]] unsigned int num_threads() const noexcept {
+    return num_threads_;
+  }
+
+ private:
+  MctsParallelism parallelism_;
+  unsigned int num_threads_;
+  uint64_t num_playouts_;
+  uint64_t seed_;
+  // a single shared one for tree parallelism, one per thread otherwise
+  std::vector<std::unique_ptr<MctsSearch<HEIGHT, WIDTH, RULES>>> searches_;
+
+  SearchResult ExploreInParallel(const Board<HEIGHT, WIDTH> &board,
+                                 Color active_player,
+                                 const Deadline &deadline,
+                                 uint64_t max_playouts) noexcept;
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+ParallelMctsExplorer<HEIGHT, WIDTH, RULES>::ParallelMctsExplorer(
+    const MctsParallelism parallelism, const unsigned int num_threads,
+    const uint64_t num_playouts, const std::size_t tree_size_in_mb,
+    const uint64_t seed)
+    : parallelism_(parallelism),
+      num_threads_(num_threads > 0
+                       ? num_threads
+                       : std::max(std::thread::hardware_concurrency(), 1U)),
+      num_playouts_(std::max<uint64_t>(num_playouts, 1)),
+      seed_(seed) {
+  if (parallelism_ == MctsParallelism::Tree) {
+    searches_.push_back(
+        std::make_unique<MctsSearch<HEIGHT, WIDTH, RULES>>(tree_size_in_mb));
+  } else {
+    for (unsigned int index = 0; index < num_threads_; ++index) {
+      searches_.push_back(std::make_unique<MctsSearch<HEIGHT, WIDTH, RULES>>(
+          tree_size_in_mb / num_threads_));
+    }
+  }
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+SearchResult ParallelMctsExplorer<HEIGHT, WIDTH, RULES>::ExploreInParallel(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    const Deadline &deadline, const uint64_t max_playouts) noexcept {
+  const auto start = clock::now();
+  for (auto &search : searches_) {
+    search->MoveRootTo(board, active_player);
+  }
+
+  // Tree parallel threads share the playout budget, while root parallel
+  // threads each get an equal share.
+  const auto is_shared = parallelism_ == MctsParallelism::Tree;
+  const auto max_playouts_per_counter =
+      is_shared ? max_playouts
+                : std::max<uint64_t>(max_playouts / num_threads_, 1);
+  std::vector<std::atomic<uint64_t>> num_started_playouts(searches_.size());
+  std::vector<uint64_t> num_playouts(num_threads_, 0);
+  const auto run = [&, this](const unsigned int index) {
+    const auto search_index = is_shared ? 0 : index;
+    num_playouts[index] = searches_[search_index]->RunPlayouts(
+        this->rules_, seed_ + index, deadline, max_playouts_per_counter,
+        num_started_playouts[search_index]);
+  };
+  std::vector<std::thread> helpers;
+  helpers.reserve(num_threads_ - 1);
+  for (unsigned int index = 1; index < num_threads_; ++index) {
+    helpers.emplace_back(run, index);
+  }
+  run(0);
+  for (auto &helper : helpers) {
+    helper.join();
+  }
+
+  // the root moves are generated in the same order for every tree
+  auto visits = searches_.front()->RootVisits();
+  uint8_t max_explored_depth = searches_.front()->max_explored_depth();
+  for (std::size_t index = 1; index < searches_.size(); ++index) {
+    const auto other_visits = searches_[index]->RootVisits();
+    if (visits.empty()) {
+      visits = other_visits;
+    } else if (other_visits.size() == visits.size()) {
+      for (std::size_t move = 0; move < visits.size(); ++move) {
+        visits[move].second += other_visits[move].second;
+      }
+    }
+    max_explored_depth =
+        std::max(max_explored_depth, searches_[index]->max_explored_depth());
+  }
+
+  uint64_t num_explored_nodes = 0;
+  for (const auto count : num_playouts) {
+    num_explored_nodes += count;
+  }
+  const auto best_move =
+      details::MostVisitedMove(visits, this->rules_, board, active_player);
+  auto principal_variation = searches_.front()->PrincipalVariation(best_move);
+  if (this->progress_callback_) {
+    this->progress_callback_(details::ProgressOf(max_explored_depth, {},
+                                                 principal_variation,
+                                                 num_explored_nodes, start));
+  }
+  const std::chrono::duration<double> seconds_spent = clock::now() - start;
+  return SearchResult{
+      .num_explored_nodes = num_explored_nodes,
+      .seconds_spent = seconds_spent.count(),
+      .best_move = best_move,
+      .max_explored_depth = max_explored_depth,
+      .winner = {},
+      .proven_value = {},
+      .principal_variation = std::move(principal_variation),
+  };
+}
+}  // namespace libsanjego
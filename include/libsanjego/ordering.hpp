@@ -0,0 +1,261 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/types.hpp"
+
+namespace libsanjego {
+/*
+ * Sorts moves so that those likely to cause a cutoff are searched first:
+ * - the best move a previous search found for the position
+ * - captures of opponent towers, the taller the earlier
+ * - killer moves, that is moves that caused a cutoff at the same distance
+ *   from the root
+ * - all other moves by how often they caused cutoffs anywhere in the tree
+ *
+ * As the killer and history tables are written without synchronization, each
+ * thread needs its own instance. They are meant to be kept across the
+ * iterations of a search.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+class MoveOrdering {
+ public:
+  /*
+   * A non-zero seed adds some noise to the history scores, which lets
+   * parallel searches diverge while they still search good moves first.
+   */
+  explicit MoveOrdering(uint64_t seed = 0) noexcept
+      : random_state_(seed), adds_noise_(seed != 0) {}
+
+  void Order(std::span<PackedMove> moves, const Board<HEIGHT, WIDTH> &board,
+             PackedMove hash_move, uint8_t ply) noexcept;
+
+  /*
+   * Remembers a move that caused a cutoff with the given remaining depth.
+   */
+  void RecordCutoff(const Board<HEIGHT, WIDTH> &board, PackedMove move,
+                    uint8_t ply, uint8_t depth_left) noexcept;
+
+  /*
+   * Lets older results lose weight against the coming iteration's.
+   */
+  void NewIteration() noexcept {
+    for (auto &score : history_) {
+      score /= 2;
+    }
+  }
+
+ private:
+  static constexpr uint32_t HASH_MOVE_SCORE = 0xFFFFFFFF;
+  // captures and killers are ranked above all history scores
+  static constexpr uint32_t CAPTURE_SCORE = 0xC0000000;
+  static constexpr uint32_t KILLER_SCORE = 0x80000000;
+  static constexpr uint32_t MAX_HISTORY_SCORE = KILLER_SCORE - 1;
+  static constexpr uint32_t NUM_KILLERS = 2;
+
+  // history indices of the killer moves per ply plus one, or 0 if unknown
+  std::array<std::array<uint32_t, NUM_KILLERS>, 256> killers_{};
+  std::array<uint32_t, HEIGHT * WIDTH * 4> history_{};
+  // scores of the moves being ordered along with their indices and the
+  // moves themselves
+  std::vector<uint64_t> keys_;
+  uint64_t random_state_;
+  const bool adds_noise_;
+
+  static uint32_t HistoryIndexOf(const PackedMove move) noexcept {
+    return move.bits();
+  }
+
+  static bool IsCapture(const Board<HEIGHT, WIDTH> &board,
+                        const PackedMove move) noexcept {
+    const auto fields = board.fields();
+    const auto source = fields[move.source_index()];
+    const auto target = fields[details::TargetIndexOf<HEIGHT, WIDTH>(move)];
+    return source.height() > 0 && target.height() > 0 &&
+           source.top() != target.top();
+  }
+
+  uint32_t Noise() noexcept {
+    // xorshift64
+    random_state_ ^= random_state_ << 13;
+    random_state_ ^= random_state_ >> 7;
+    random_state_ ^= random_state_ << 17;
+    return static_cast<uint32_t>(random_state_ % 64);
+  }
+
+  uint32_t ScoreOf(const Board<HEIGHT, WIDTH> &board, PackedMove move,
+                   PackedMove hash_move, uint8_t ply) noexcept;
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+uint32_t MoveOrdering<HEIGHT, WIDTH>::ScoreOf(
+    const Board<HEIGHT, WIDTH> &board, const PackedMove move,
+    const PackedMove hash_move, const uint8_t ply) noexcept {
+  if (move == hash_move) {
+    return HASH_MOVE_SCORE;
+  }
+  if (IsCapture(board, move)) {
+    return CAPTURE_SCORE +
+           board.fields()[details::TargetIndexOf<HEIGHT, WIDTH>(move)]
+               .height();
+  }
+  const auto history_index = HistoryIndexOf(move);
+  for (uint32_t index = 0; index < NUM_KILLERS; ++index) {
+    if (killers_[ply][index] == history_index + 1) {
+      return KILLER_SCORE + NUM_KILLERS - index;
+    }
+  }
+  auto score = history_[history_index];
+  if (adds_noise_) {
+    score = std::min(score + Noise(), MAX_HISTORY_SCORE);
+  }
+  return score;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+void MoveOrdering<HEIGHT, WIDTH>::Order(const std::span<PackedMove> moves,
+                                        const Board<HEIGHT, WIDTH> &board,
+                                        const PackedMove hash_move,
+                                        const uint8_t ply) noexcept {
+  keys_.clear();
+  for (std::size_t index = 0; index < moves.size(); ++index) {
+    // The inverted index keeps equally scored moves in generation order.
+    // Boards have at most a quarter as many fields as there are 16 bit
+    // numbers, so neither the index nor the move overflows its half word.
+    const auto move = moves[index];
+    keys_.push_back(uint64_t{ScoreOf(board, move, hash_move, ply)} << 32 |
+                    (0xFFFF - index) << 16 | move.bits());
+  }
+  std::sort(keys_.begin(), keys_.end(), std::greater<>());
+  for (std::size_t index = 0; index < moves.size(); ++index) {
+    const auto bits = static_cast<uint16_t>(keys_[index] & 0xFFFF);
+    moves[index] = PackedMove(bits >> 2, static_cast<Direction>(bits & 3));
+  }
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+void MoveOrdering<HEIGHT, WIDTH>::RecordCutoff(
+    const Board<HEIGHT, WIDTH> &board, const PackedMove move,
+    const uint8_t ply, const uint8_t depth_left) noexcept {
+  // captures are searched early anyway
+  if (IsCapture(board, move)) {
+    return;
+  }
+  const auto history_index = HistoryIndexOf(move);
+  auto &killers = killers_[ply];
+  if (killers[0] != history_index + 1) {
+    killers[1] = killers[0];
+    killers[0] = history_index + 1;
+  }
+  auto &score = history_[history_index];
+  score = std::min<uint32_t>(score + uint32_t{depth_left} * depth_left,
+                             MAX_HISTORY_SCORE);
+}
+
+/*
+ * Hands out the legal moves of a position in the order MoveOrdering sorts
+ * them in. The hash move comes first and is handed out before any other
+ * move is generated, so nodes where it causes a cutoff never generate or
+ * order the others.
+ * The board has to be in the given position whenever moves are requested.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class StagedMoves {
+ public:
+  StagedMoves(const RULES &rules, MoveOrdering<HEIGHT, WIDTH> &ordering,
+              const Board<HEIGHT, WIDTH> &board, const Color active_player,
+              const PackedMove hash_move, const uint8_t ply) noexcept
+      : rules_(rules),
+        ordering_(ordering),
+        board_(board),
+        active_player_(active_player),
+        hash_move_(hash_move),
+        ply_(ply),
+        hash_move_is_legal_(not hash_move.IsSkip() &&
+                            rules.MoveIsAllowedOn(board, hash_move,
+                                                  active_player)) {}
+
+  /*
+   * Returns the next move, or nothing once all moves were handed out.
+   */
+  std::optional<PackedMove> Next() noexcept {
+    if (not generated_) {
+      if (hash_move_is_legal_ && num_handed_out_ == 0) {
+        ++num_handed_out_;
+        return hash_move_;
+      }
+      Generate();
+    }
+    if (num_handed_out_ < moves_.size()) {
+      return moves_[num_handed_out_++];
+    }
+    return {};
+  }
+
+  [[nodiscard]] bool HasAny() noexcept {
+    if (hash_move_is_legal_) {
+      return true;
+    }
+    Generate();
+    return not moves_.empty();
+  }
+
+  /*
+   * Returns all moves in order, including those handed out already.
+   */
+  std::span<const PackedMove> All() noexcept {
+    Generate();
+    return {moves_.begin(), moves_.end()};
+  }
+
+ private:
+  const RULES &rules_;
+  MoveOrdering<HEIGHT, WIDTH> &ordering_;
+  const Board<HEIGHT, WIDTH> &board_;
+  const Color active_player_;
+  const PackedMove hash_move_;
+  const uint8_t ply_;
+  const bool hash_move_is_legal_;
+  bool generated_ = false;
+  uint32_t num_handed_out_ = 0;
+  MoveList<HEIGHT, WIDTH> moves_;
+
+  void Generate() noexcept {
+    if (generated_) {
+      return;
+    }
+    generated_ = true;
+    rules_.GenerateLegalMoves(board_, active_player_, moves_);
+    // puts a legal hash move first, in line with it having been handed out
+    ordering_.Order(moves_, board_, hash_move_, ply_);
+  }
+};
+}  // namespace libsanjego
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "libsanjego/bot.hpp"
+#include "libsanjego/deadline.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/types.hpp"
+
+namespace libsanjego {
+/*
+ * Lets an explorer think while the opponent does.
+ *
+ * After the own move, Start searches the position that the opponent's
+ * expected reply leads to in the background, without a time limit. Once the
+ * opponent has moved, Explore either lets that search go on until the real
+ * deadline if the reply was the expected one, or stops it and starts over.
+ * Even then the new search profits from what the explorer keeps between
+ * searches, like its transposition table or Monte-Carlo tree.
+ *
+ * The explorer must outlive the ponderer and must not be used by others
+ * while it is pondering.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class Ponderer {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+  explicit Ponderer(Explorer<HEIGHT, WIDTH, RULES> &explorer) noexcept
+      : explorer_(explorer) {}
+  Ponderer(const Ponderer &other) = delete;
+  Ponderer &operator=(const Ponderer &other) = delete;
+  ~Ponderer() { Stop(); }
+
+  /*
+   * Starts pondering on the position after the given move of the opponent,
+   * which is usually the second move of the principal variation of the own
+   * last search. Returns whether the move is legal and pondering started.
+   */
+  bool Start(const Board<HEIGHT, WIDTH> &board, Color opponent,
+             const Move &expected_move) noexcept;
+
+  /*
+   * Explores the position after the opponent's actual move until the given
+   * point in time. If it is the position pondered on, the time spent
+   * pondering counts towards the result.
+   */
+  SearchResult Explore(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                       clock::time_point deadline) noexcept;
+
+  /*
+   * Stops pondering and discards its result.
+   */
+  void Stop() noexcept;
+
+  [[nodiscard]] bool is_pondering() const noexcept {
+    return thread_.joinable();
+  }
+  // number of searches that could continue pondering
+  [[nodiscard]] uint64_t num_hits() const noexcept { return num_hits_; }
+  // number of searches that had to start over
+  [[nodiscard]] uint64_t num_misses() const noexcept { return num_misses_; }
+
+ private:
+  Explorer<HEIGHT, WIDTH, RULES> &explorer_;
+  const RULES rules_{};
+  Deadline deadline_;
+  std::thread thread_;
+  // the position pondered on
+  Board<HEIGHT, WIDTH> board_;
+  Color active_player_ = Color::Blue;
+  std::optional<SearchResult> result_;
+  uint64_t num_hits_ = 0;
+  uint64_t num_misses_ = 0;
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+bool Ponderer<HEIGHT, WIDTH, RULES>::Start(const Board<HEIGHT, WIDTH> &board,
+                                           const Color opponent,
+                                           const Move &expected_move) noexcept {
+  Stop();
+  auto moves = rules_.GetLegalMoves(board, opponent);
+  board_ = board;
+  if (moves.empty()) {
+    // the opponent has to skip
+    if (not expected_move.IsSkip()) {
+      return false;
+    }
+  } else {
+    const auto move = std::find(moves.begin(), moves.end(), expected_move);
+    if (move == moves.end()) {
+      return false;
+    }
+    board_.Make(*move);
+  }
+  active_player_ = details::OpponentOf(opponent);
+  result_.reset();
+  deadline_.MoveTo(clock::time_point::max());
+  thread_ = std::thread([this] {
+    result_ = explorer_.Explore(board_, active_player_, deadline_);
+  });
+  return true;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+SearchResult Ponderer<HEIGHT, WIDTH, RULES>::Explore(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    const clock::time_point deadline) noexcept {
+  if (is_pondering()) {
+    if (active_player == active_player_ && board.hash() == board_.hash()) {
+      deadline_.MoveTo(deadline);
+      thread_.join();
+      ++num_hits_;
+      return std::move(result_.value());
+    }
+    Stop();
+  }
+  ++num_misses_;
+  return explorer_.Explore(board, active_player, deadline);
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+void Ponderer<HEIGHT, WIDTH, RULES>::Stop() noexcept {
+  if (not is_pondering()) {
+    return;
+  }
+  deadline_.MoveTo(clock::time_point::min());
+  thread_.join();
+  result_.reset();
+}
+}  // namespace libsanjego
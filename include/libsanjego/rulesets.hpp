@@ -18,10 +18,16 @@
  */
 #pragma once
 
+#include <algorithm>
 #include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <span>
+#include <utility>
 #include <vector>
 
 #include "gameobjects.hpp"
@@ -30,35 +36,50 @@ namespace libsanjego {
 /*
  * A ruleset brings life into game objects and defines how they are allowed to
  * interact with each other.
+ * Searches take their ruleset as a template parameter, so that calls to it
+ * are resolved at compile time and can be inlined. They only use it through
+ * const references, which lets threads share a ruleset that keeps no state.
  */
-template <board_size_t HEIGHT, board_size_t WIDTH>
-class Ruleset {
- public:
-  virtual bool MoveIsAllowedOn(const Board<HEIGHT, WIDTH> &board,
-                               const Move &move,
-                               const Color active_player) noexcept = 0;
+template <typename RULES, board_size_t HEIGHT, board_size_t WIDTH>
+concept Ruleset = requires(const RULES &rules,
+                           const Board<HEIGHT, WIDTH> &board,
+                           const Move &move, const PackedMove packed_move,
+                           const Color active_player, const Tower &tower,
+                           const std::span<const PackedMove> packed_moves,
+                           const std::span<int8_t> values,
+                           MoveList<HEIGHT, WIDTH> &move_list) {
+  { rules.MoveIsAllowedOn(board, move, active_player) } -> std::same_as<bool>;
+  {
+    rules.MoveIsAllowedOn(board, packed_move, active_player)
+  } -> std::same_as<bool>;
   /*
    * Returns the game-theoretical value of the given game board from the first
    * player's point of view, that is positive values indicate a better position
    * for the first player while negative values are better for the second.
    */
-  virtual int8_t ComputeValueOf(const Board<HEIGHT, WIDTH> &board) noexcept = 0;
-
-  virtual std::vector<Move> GetLegalMoves(
-      const Board<HEIGHT, WIDTH> &board,
-      const Color active_player) noexcept = 0;
-
+  { rules.ComputeValueOf(board) } -> std::same_as<int8_t>;
+  rules.ComputeValuesAfter(board, packed_moves, values);
+  {
+    rules.BoundFinalValueOf(board)
+  } -> std::same_as<std::pair<int8_t, int8_t>>;
+  {
+    rules.GetLegalMoves(board, active_player)
+  } -> std::same_as<std::vector<Move>>;
+  {
+    rules.GetLegalPackedMoves(board, active_player)
+  } -> std::same_as<std::vector<PackedMove>>;
+  rules.GenerateLegalMoves(board, active_player, move_list);
+  { rules.HasLegalMoves(board, active_player) } -> std::same_as<bool>;
   /*
    * Returns whether the player with the given color is allowed to move the
    * given tower. In the standard ruleset, this is the case if the top brick of
    * the tower has the given color.
    */
-  [[nodiscard]] virtual bool OwnsTower(const Color,
-                                       const Tower &) const noexcept = 0;
+  { rules.OwnsTower(active_player, tower) } -> std::same_as<bool>;
 };
 
 template <board_size_t HEIGHT, board_size_t WIDTH>
-class StandardRuleset : Ruleset<HEIGHT, WIDTH> {
+class StandardRuleset {
  public:
   /*
    * In this ruleset, a move is allowed if all these conditions hold:
@@ -67,7 +88,9 @@ class StandardRuleset : Ruleset<HEIGHT, WIDTH> {
    * - the source tower is owned by the active player
    */
   bool MoveIsAllowedOn(const Board<HEIGHT, WIDTH> &board, const Move &move,
-                       const Color active_player) noexcept;
+                       const Color active_player) const noexcept;
+  bool MoveIsAllowedOn(const Board<HEIGHT, WIDTH> &board, PackedMove move,
+                       Color active_player) const noexcept;
   /*
    * Returns the game-theoretical value of the given game board from the first
    * player's point of view, that is positive values indicate a better position
@@ -76,10 +99,51 @@ class StandardRuleset : Ruleset<HEIGHT, WIDTH> {
    * In this ruleset, the value is the difference in height of the highest
    * tower of each player.
    */
-  int8_t ComputeValueOf(const Board<HEIGHT, WIDTH> &board) noexcept;
+  int8_t ComputeValueOf(const Board<HEIGHT, WIDTH> &board) const noexcept;
+
+  /*
+   * Stores the value ComputeValueOf would return after each of the given
+   * legal moves at the same index of values, which must be at least as long
+   * as moves. The board is left untouched, as the values follow from the
+   * heights and owners of the source and target towers alone.
+   */
+  void ComputeValuesAfter(const Board<HEIGHT, WIDTH> &board,
+                          std::span<const PackedMove> moves,
+                          std::span<int8_t> values) const noexcept;
+
+  /*
+   * Returns a lower and an upper bound of the value the game ends with if it
+   * is played to the end from the given board, no matter how.
+   */
+  std::pair<int8_t, int8_t> BoundFinalValueOf(
+      const Board<HEIGHT, WIDTH> &board) const noexcept;
 
   std::vector<Move> GetLegalMoves(const Board<HEIGHT, WIDTH> &board,
-                                  const Color active_player) noexcept;
+                                  const Color active_player) const noexcept;
+
+  /*
+   * Returns the same moves as GetLegalMoves, in the same order, but packed.
+   */
+  std::vector<PackedMove> GetLegalPackedMoves(
+      const Board<HEIGHT, WIDTH> &board,
+      const Color active_player) const noexcept;
+
+  /*
+   * Adds the moves GetLegalPackedMoves returns to the given list without
+   * allocating. On boards that keep bitboards, the towers that can move in
+   * each direction are found with a shift and a mask of the whole board
+   * rather than field by field.
+   */
+  void GenerateLegalMoves(const Board<HEIGHT, WIDTH> &board,
+                          Color active_player,
+                          MoveList<HEIGHT, WIDTH> &moves) const noexcept;
+
+  /*
+   * Returns whether the player has any legal move, which takes only as long
+   * as finding the first one.
+   */
+  bool HasLegalMoves(const Board<HEIGHT, WIDTH> &board,
+                     Color active_player) const noexcept;
   /*
    * Returns whether the player with the given color is allowed to move the
    * given tower. This is the case if the top brick of the tower has the given
@@ -97,7 +161,7 @@ class StandardRuleset : Ruleset<HEIGHT, WIDTH> {
 template <board_size_t HEIGHT, board_size_t WIDTH>
 bool StandardRuleset<HEIGHT, WIDTH>::MoveIsAllowedOn(
     const Board<HEIGHT, WIDTH> &board, const Move &move,
-    const Color active_player) noexcept {
+    const Color active_player) const noexcept {
   if (move.source == move.target) {
     return false;
   }
@@ -135,23 +199,142 @@ auto GetMovesToQuadNeighboursOn(const Board<HEIGHT, WIDTH> &board,
 }  // namespace details
 template <board_size_t HEIGHT, board_size_t WIDTH>
 std::vector<Move> StandardRuleset<HEIGHT, WIDTH>::GetLegalMoves(
-    const Board<HEIGHT, WIDTH> &board, const Color active_player) noexcept {
+    const Board<HEIGHT, WIDTH> &board,
+    const Color active_player) const noexcept {
+  MoveList<HEIGHT, WIDTH> moves;
+  GenerateLegalMoves(board, active_player, moves);
   std::vector<Move> legal_moves;
+  legal_moves.reserve(moves.size());
+  for (const auto move : moves) {
+    legal_moves.push_back(UnpackMove<HEIGHT, WIDTH>(move));
+  }
+  return legal_moves;
+}
 
-  for (board_size_t row = 0; row < HEIGHT; ++row) {
-    for (board_size_t col = 0; col < WIDTH; ++col) {
-      const Position pos{row, col};
-      auto moves_to_neighbours =
-          details::GetMovesToQuadNeighboursOn(board, pos);
-      for (auto &move : moves_to_neighbours) {
-        if (MoveIsAllowedOn(board, move, active_player)) {
-          legal_moves.push_back(move);
+template <board_size_t HEIGHT, board_size_t WIDTH>
+bool StandardRuleset<HEIGHT, WIDTH>::MoveIsAllowedOn(
+    const Board<HEIGHT, WIDTH> &board, const PackedMove move,
+    const Color active_player) const noexcept {
+  if (not details::StaysOnBoard<HEIGHT, WIDTH>(move)) {
+    return false;
+  }
+  const auto fields = board.fields();
+  const auto source = fields[move.source_index()];
+  return source.height() > 0 && OwnsTower(active_player, source) &&
+         fields[details::TargetIndexOf<HEIGHT, WIDTH>(move)].height() > 0;
+}
+
+namespace details {
+constexpr std::array<Direction, 4> DIRECTIONS{Direction::Down, Direction::Up,
+                                              Direction::Right,
+                                              Direction::Left};
+
+/*
+ * Returns bitboards of the fields whose neighbour in a direction lies on the
+ * board, indexed by the direction.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+constexpr std::array<uint64_t, 4> SourceMasksOf() noexcept {
+  std::array<uint64_t, 4> masks{};
+  for (uint32_t index = 0; index < HEIGHT * WIDTH; ++index) {
+    for (const auto direction : DIRECTIONS) {
+      if (StaysOnBoard<HEIGHT, WIDTH>(PackedMove{index, direction})) {
+        masks[static_cast<uint8_t>(direction)] |= uint64_t{1} << index;
+      }
+    }
+  }
+  return masks;
+}
+
+/*
+ * Returns bitboards of the towers the player can move in a direction, that
+ * is those with another tower next to them, indexed by the direction.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+constexpr std::array<uint64_t, 4> MovableTowersOf(
+    const Board<HEIGHT, WIDTH> &board, const Color player) noexcept
+  requires Board<HEIGHT, WIDTH>::USES_BITBOARDS
+{
+  constexpr auto MASKS = SourceMasksOf<HEIGHT, WIDTH>();
+  // A board of a single row may be 64 fields wide; nothing can move down or
+  // up on it, which the masks take care of.
+  constexpr auto ROW_SHIFT = WIDTH % 64;
+  const auto owned = board.OwnedBy(player);
+  const auto occupied = board.occupied();
+  return {owned & MASKS[0] & (occupied >> ROW_SHIFT),
+          owned & MASKS[1] & (occupied << ROW_SHIFT),
+          owned & MASKS[2] & (occupied >> 1),
+          owned & MASKS[3] & (occupied << 1)};
+}
+}  // namespace details
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+void StandardRuleset<HEIGHT, WIDTH>::GenerateLegalMoves(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    MoveList<HEIGHT, WIDTH> &moves) const noexcept {
+  if constexpr (Board<HEIGHT, WIDTH>::USES_BITBOARDS) {
+    const auto movable = details::MovableTowersOf(board, active_player);
+    // visits the sources in order to generate the moves in the same order
+    // as below
+    for (auto sources = movable[0] | movable[1] | movable[2] | movable[3];
+         sources != 0; sources &= sources - 1) {
+      const auto index = static_cast<uint32_t>(std::countr_zero(sources));
+      for (const auto direction : details::DIRECTIONS) {
+        if ((movable[static_cast<uint8_t>(direction)] >> index) & 1) {
+          moves.Add(PackedMove{index, direction});
         }
       }
     }
+    return;
   }
+  const auto fields = board.fields();
+  for (uint32_t index = 0; index < fields.size(); ++index) {
+    if (fields[index].height() == 0 ||
+        not OwnsTower(active_player, fields[index])) {
+      continue;
+    }
+    for (const auto direction : details::DIRECTIONS) {
+      const PackedMove move{index, direction};
+      const auto target = details::TargetIndexOf<HEIGHT, WIDTH>(move);
+      if (target != details::NO_NEIGHBOUR && fields[target].height() > 0) {
+        moves.Add(move);
+      }
+    }
+  }
+}
 
-  return legal_moves;
+template <board_size_t HEIGHT, board_size_t WIDTH>
+bool StandardRuleset<HEIGHT, WIDTH>::HasLegalMoves(
+    const Board<HEIGHT, WIDTH> &board,
+    const Color active_player) const noexcept {
+  if constexpr (Board<HEIGHT, WIDTH>::USES_BITBOARDS) {
+    const auto movable = details::MovableTowersOf(board, active_player);
+    return (movable[0] | movable[1] | movable[2] | movable[3]) != 0;
+  }
+  const auto fields = board.fields();
+  for (uint32_t index = 0; index < fields.size(); ++index) {
+    if (fields[index].height() == 0 ||
+        not OwnsTower(active_player, fields[index])) {
+      continue;
+    }
+    for (const auto direction : details::DIRECTIONS) {
+      const PackedMove move{index, direction};
+      const auto target = details::TargetIndexOf<HEIGHT, WIDTH>(move);
+      if (target != details::NO_NEIGHBOUR && fields[target].height() > 0) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+std::vector<PackedMove> StandardRuleset<HEIGHT, WIDTH>::GetLegalPackedMoves(
+    const Board<HEIGHT, WIDTH> &board,
+    const Color active_player) const noexcept {
+  MoveList<HEIGHT, WIDTH> moves;
+  GenerateLegalMoves(board, active_player, moves);
+  return {moves.begin(), moves.end()};
 }
 
 typedef std::int8_t game_value_t;
@@ -163,10 +346,111 @@ typedef std::int8_t game_value_t;
  */
 template <board_size_t HEIGHT, board_size_t WIDTH>
 game_value_t StandardRuleset<HEIGHT, WIDTH>::ComputeValueOf(
-    const Board<HEIGHT, WIDTH> &board) noexcept {
+    const Board<HEIGHT, WIDTH> &board) const noexcept {
   return board.MaxHeightOf(Color::Blue) - board.MaxHeightOf(Color::Yellow);
 }
 
+/*
+ * The stacked tower is taller than both of its parts, so the moving player's
+ * highest tower is either the stacked one or the one they had before. The
+ * opponent can only lose the target tower, which matters if it was their
+ * only highest one.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+void StandardRuleset<HEIGHT, WIDTH>::ComputeValuesAfter(
+    const Board<HEIGHT, WIDTH> &board, const std::span<const PackedMove> moves,
+    const std::span<game_value_t> values) const noexcept {
+  // indexed by color
+  const std::array<tower_size_t, 2> max_heights{
+      board.MaxHeightOf(Color::Blue), board.MaxHeightOf(Color::Yellow)};
+  const std::array<tower_size_t, 2> runner_up_heights{
+      board.RunnerUpHeightOf(Color::Blue),
+      board.RunnerUpHeightOf(Color::Yellow)};
+  const auto fields = board.fields();
+  for (std::size_t index = 0; index < moves.size(); ++index) {
+    const auto &move = moves[index];
+    const auto source = fields[move.source_index()];
+    const auto target = fields[details::TargetIndexOf<HEIGHT, WIDTH>(move)];
+    const auto mover = static_cast<uint8_t>(source.top());
+    const auto opponent = mover ^ 1;
+    const auto mover_height = std::max<tower_size_t>(
+        max_heights[mover], source.height() + target.height());
+    const auto loses_highest =
+        static_cast<uint8_t>(target.top()) == opponent &&
+        target.height() == max_heights[opponent] &&
+        runner_up_heights[opponent] < max_heights[opponent];
+    const auto opponent_height = loses_highest ? runner_up_heights[opponent]
+                                               : max_heights[opponent];
+    const int value = mover_height - opponent_height;
+    values[index] = static_cast<game_value_t>(
+        source.top() == Color::Blue ? value : -value);
+  }
+}
+
+/*
+ * Towers can only be stacked onto adjacent towers, hence they never leave the
+ * group of connected towers they are part of. No tower can grow taller than
+ * the sum of its group, and a player can only end up owning a tower of a
+ * group if they own one of its towers already. A tower without any neighbour
+ * never changes anymore.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+std::pair<game_value_t, game_value_t>
+StandardRuleset<HEIGHT, WIDTH>::BoundFinalValueOf(
+    const Board<HEIGHT, WIDTH> &board) const noexcept {
+  // indexed by color
+  std::array<tower_size_t, 2> lower_bounds{0, 0};
+  std::array<tower_size_t, 2> upper_bounds{0, 0};
+
+  std::array<bool, HEIGHT * WIDTH> visited{};
+  // indices of towers whose neighbours still have to be visited
+  std::array<uint16_t, HEIGHT * WIDTH> pending{};
+  const auto fields = board.fields();
+  for (uint16_t start = 0; start < fields.size(); ++start) {
+    if (fields[start].height() == 0 || visited[start]) {
+      continue;
+    }
+    // collects the group of towers connected to the start tower
+    visited[start] = true;
+    pending[0] = start;
+    std::size_t num_pending = 1;
+    std::size_t group_size = 0;
+    tower_size_t group_height = 0;
+    std::array<bool, 2> owners{false, false};
+    while (num_pending > 0) {
+      const auto index = pending[--num_pending];
+      const auto tower = fields[index];
+      ++group_size;
+      group_height += tower.height();
+      owners[static_cast<uint8_t>(tower.top())] = true;
+      for (const auto direction : details::DIRECTIONS) {
+        const auto neighbour = details::TargetIndexOf<HEIGHT, WIDTH>(
+            PackedMove{index, direction});
+        if (neighbour == details::NO_NEIGHBOUR ||
+            fields[neighbour].height() == 0 || visited[neighbour]) {
+          continue;
+        }
+        visited[neighbour] = true;
+        pending[num_pending++] = neighbour;
+      }
+    }
+
+    for (uint8_t color = 0; color < 2; ++color) {
+      if (owners[color]) {
+        upper_bounds[color] = std::max(upper_bounds[color], group_height);
+        if (group_size == 1) {
+          lower_bounds[color] = std::max(lower_bounds[color], group_height);
+        }
+      }
+    }
+  }
+
+  const auto blue = static_cast<uint8_t>(Color::Blue);
+  const auto yellow = static_cast<uint8_t>(Color::Yellow);
+  return {lower_bounds[blue] - upper_bounds[yellow],
+          upper_bounds[blue] - lower_bounds[yellow]};
+}
+
 template <board_size_t HEIGHT, board_size_t WIDTH>
 bool StandardRuleset<HEIGHT, WIDTH>::OwnsTower(
     const Color active_player, const Tower &tower) const noexcept {
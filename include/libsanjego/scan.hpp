@@ -0,0 +1,74 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <span>
+
+#include "gameobjects.hpp"
+
+namespace libsanjego {
+/*
+ * What a full scan of a board's fields found out about one player.
+ */
+struct OwnerScan {
+  tower_size_t max_height;
+  uint32_t num_towers;
+
+  bool operator==(const OwnerScan &) const noexcept = default;
+};
+
+/*
+ * Scans the given towers for the ones owned by the given player, using the
+ * widest vector instructions the CPU supports. Empty fields are skipped.
+ */
+OwnerScan ScanTowersOf(std::span<const Tower> towers,
+                       Color owner) noexcept;
+
+/*
+ * Returns the number of towers the given player owns on the board. Boards
+ * with bitboards just count bits, larger ones scan their fields.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+uint32_t CountTowersOf(const Board<HEIGHT, WIDTH> &board,
+                       const Color owner) noexcept {
+  if constexpr (Board<HEIGHT, WIDTH>::USES_BITBOARDS) {
+    return std::popcount(board.OwnedBy(owner));
+  } else {
+    return ScanTowersOf(board.fields(), owner).num_towers;
+  }
+}
+
+namespace details {
+enum class SimdLevel : uint8_t { Scalar, Sse41, Avx2 };
+
+/*
+ * Returns the widest kernel that ScanTowersOf dispatches to on this CPU.
+ */
+SimdLevel DetectedSimdLevel() noexcept;
+
+/*
+ * Runs the kernel of the given level, which must not exceed the detected
+ * one. Exposed for testing the kernels against each other.
+ */
+OwnerScan ScanTowersWith(SimdLevel level, std::span<const Tower> towers,
+                         Color owner) noexcept;
+}  // namespace details
+}  // namespace libsanjego
@@ -0,0 +1,92 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace libsanjego {
+/*
+ * Runs tasks on a fixed set of threads. Each thread has its own deque of
+ * tasks: it pushes and pops tasks at the back, while idle threads steal the
+ * oldest tasks from the front of other deques.
+ *
+ * The thread that creates the scheduler counts as worker 0. It does not run
+ * tasks on its own, but only while it waits in HelpUntil.
+ */
+class WorkStealingScheduler {
+ public:
+  typedef std::function<void()> Task;
+
+  /*
+   * Creates a scheduler with the given number of workers (at least one),
+   * including the calling thread.
+   */
+  explicit WorkStealingScheduler(unsigned int num_workers);
+  ~WorkStealingScheduler();
+  WorkStealingScheduler(const WorkStealingScheduler &) = delete;
+  WorkStealingScheduler &operator=(const WorkStealingScheduler &) = delete;
+
+  /*
+   * Queues the task on the calling worker's deque.
+   */
+  void Spawn(Task task);
+
+  /*
+   * Runs queued tasks on the calling thread until the predicate holds.
+   * Tasks may call this recursively to wait for tasks they spawned.
+   */
+  void HelpUntil(const std::function<bool()> &done);
+
+  [[nodiscard]] unsigned int num_workers() const noexcept {
+    return static_cast<unsigned int>(workers_.size());
+  }
+
+  /*
+   * Returns the index of the calling thread among this scheduler's workers,
+   * where threads not owned by the scheduler have index 0.
+   */
+  [[nodiscard]] unsigned int CurrentWorkerIndex() const noexcept;
+
+ private:
+  struct alignas(64) Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<bool> shutting_down_ = false;
+  std::atomic<uint64_t> num_queued_tasks_ = 0;
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_up_;
+
+  std::optional<Task> TryPop(unsigned int worker_index);
+  std::optional<Task> TrySteal(unsigned int thief_index);
+  void Run(unsigned int worker_index);
+};
+}  // namespace libsanjego
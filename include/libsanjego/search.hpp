@@ -0,0 +1,624 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "libsanjego/deadline.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/ordering.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/symmetry.hpp"
+#include "libsanjego/tablebase.hpp"
+#include "libsanjego/transposition.hpp"
+#include "libsanjego/types.hpp"
+
+namespace libsanjego {
+namespace details {
+// bounds that are never reached by an actual game value
+constexpr int SCORE_INFINITY = std::numeric_limits<int16_t>::max();
+
+// The clock is only read once every this many nodes to keep it off the hot
+// path. Must be a power of two.
+constexpr uint64_t NODES_BETWEEN_CLOCK_CHECKS = 1024;
+
+constexpr Color OpponentOf(const Color color) noexcept {
+  return color == Color::Blue ? Color::Yellow : Color::Blue;
+}
+
+/*
+ * Moves the given move to the front of the list if it is part of it.
+ * Returns whether it was found.
+ */
+inline bool MoveToFront(std::vector<PackedMove> &moves,
+                        const PackedMove move) noexcept {
+  const auto position = std::find(moves.begin(), moves.end(), move);
+  if (position == moves.end()) {
+    return false;
+  }
+  std::rotate(moves.begin(), position, position + 1);
+  return true;
+}
+
+/*
+ * The key of a position in a transposition table along with the symmetry
+ * that maps the position's moves to the moves stored under the key.
+ */
+struct TableKey {
+  uint64_t key;
+  Symmetry symmetry;
+};
+
+/*
+ * Symmetric keys are shared by all equivalent positions, see
+ * CanonicalKeyOf.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+TableKey TableKeyOf(const Board<HEIGHT, WIDTH> &board,
+                    const Color active_player,
+                    const bool uses_symmetric_keys) noexcept {
+  if (uses_symmetric_keys) {
+    const auto canonical = CanonicalKeyOf(board, active_player);
+    // the representative always has the first player to move
+    return {KeyOf(canonical.hash, Color::Blue), canonical.symmetry};
+  }
+  return {KeyOf(board.hash(), active_player), Symmetry{0, false}};
+}
+
+/*
+ * Returns the line of play that a search expects, starting with the given
+ * move and continuing with the best moves stored in the transposition table.
+ * It ends after max_length half-turns, at the end of the game, or at the
+ * first position without a legal stored move. Players without legal moves
+ * skip.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+std::vector<Move> PrincipalVariationOf(const RULES &rules,
+                                       TranspositionTable &transposition_table,
+                                       Board<HEIGHT, WIDTH> board,
+                                       Color active_player, Move first_move,
+                                       const uint8_t max_length,
+                                       const bool uses_symmetric_keys) noexcept {
+  std::vector<Move> variation;
+  auto next_move = std::optional<Move>(first_move);
+  while (variation.size() < max_length) {
+    const auto moves = rules.GetLegalMoves(board, active_player);
+    if (moves.empty()) {
+      if (rules.GetLegalMoves(board, OpponentOf(active_player)).empty()) {
+        break;
+      }
+      variation.push_back(Move::Skip());
+    } else {
+      const auto move = next_move.has_value()
+                            ? std::find(moves.begin(), moves.end(),
+                                        next_move.value())
+                            : moves.end();
+      if (move == moves.end()) {
+        break;
+      }
+      variation.push_back(*move);
+      board.Make(variation.back());
+    }
+    active_player = OpponentOf(active_player);
+
+    next_move.reset();
+    const auto [key, symmetry] =
+        TableKeyOf(board, active_player, uses_symmetric_keys);
+    if (const auto entry = transposition_table.Probe(key)) {
+      next_move =
+          Transform<HEIGHT, WIDTH>(entry->best_move, InverseOf(symmetry));
+    }
+  }
+  return variation;
+}
+
+/*
+ * A small and fast pseudo random number generator (xorshift64*).
+ */
+class Xorshift {
+ public:
+  explicit Xorshift(uint64_t seed) noexcept : state_(seed | 1) {}
+  uint64_t operator()() noexcept {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return state_ * 0x2545F4914F6CDD1DULL;
+  }
+
+ private:
+  uint64_t state_;
+};
+}  // namespace details
+
+/*
+ * What a search reports about each iteration it completes.
+ */
+struct SearchProgress {
+  // counted in half-turns
+  uint8_t depth;
+  // the value of the root from the first player's point of view, if the
+  // search computes one
+  std::optional<int16_t> score;
+  std::vector<Move> principal_variation;
+  uint64_t num_explored_nodes;
+  double seconds_spent;
+  double nodes_per_second;
+};
+
+/*
+ * Receives progress reports, on the thread of the search that sends them.
+ */
+typedef std::function<void(const SearchProgress &)> ProgressCallback;
+
+namespace details {
+inline SearchProgress ProgressOf(
+    const uint8_t depth, const std::optional<int16_t> score,
+    std::vector<Move> principal_variation, const uint64_t num_explored_nodes,
+    const std::chrono::steady_clock::time_point start) noexcept {
+  const std::chrono::duration<double> seconds_spent =
+      std::chrono::steady_clock::now() - start;
+  return {depth,
+          score,
+          std::move(principal_variation),
+          num_explored_nodes,
+          seconds_spent.count(),
+          seconds_spent.count() > 0.0
+              ? static_cast<double>(num_explored_nodes) / seconds_spent.count()
+              : 0.0};
+}
+}  // namespace details
+
+/*
+ * A single-threaded alpha-beta pruned negamax search on a private copy of a
+ * board. Several instances can work on the same position in parallel if they
+ * share a transposition table.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class AlphaBetaSearch {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+  /*
+   * Prepares a search of the given position that is aborted once the
+   * deadline has passed or the stop signal is set. Both must outlive the
+   * search.
+   * A non-zero seed perturbs the order in which moves are searched, which
+   * lets parallel instances diverge.
+   */
+  AlphaBetaSearch(const RULES &rules, TranspositionTable &transposition_table,
+                  const Board<HEIGHT, WIDTH> &board, Color active_player,
+                  const Deadline &deadline,
+                  const std::atomic<bool> *stop_signal = nullptr,
+                  uint64_t seed = 0)
+      : rules_(rules),
+        transposition_table_(transposition_table),
+        board_(board),
+        active_player_(active_player),
+        deadline_(deadline),
+        stop_signal_(stop_signal),
+        random_(seed),
+        shuffles_moves_(seed != 0),
+        ordering_(seed),
+        root_moves_(rules.GetLegalPackedMoves(board, active_player)),
+        start_(clock::now()) {
+    ordering_.Order(root_moves_, board_, PackedMove::Skip(), 0);
+  }
+
+  /*
+   * Searches all root moves to the given depth and returns the best of them,
+   * or nothing if the search was aborted before it completed.
+   * The move searched first wins ties.
+   */
+  std::optional<Move> SearchRoot(uint8_t depth) noexcept;
+
+  /*
+   * Deepens the search one half-turn at a time, starting at first_depth,
+   * until max_depth is reached, the search is aborted, or the game tree has
+   * been searched completely.
+   * Returns the best move of the deepest completed iteration. If there is
+   * none, this is the first legal move or a skip if there is no such move.
+   */
+  Move IterativelyDeepen(uint8_t first_depth, uint8_t max_depth) noexcept;
+
+  /*
+   * Lets the search skip subtrees whose final value is already known well
+   * enough from StandardRuleset::BoundFinalValueOf. This costs a pass over the
+   * board per node and pays off when searching to the end of the game.
+   */
+  void EnableFinalValuePruning() noexcept { prunes_by_final_value_ = true; }
+
+  /*
+   * Lets all positions that are equivalent by symmetry share their entry in
+   * the transposition table, which saves memory and finds more
+   * transpositions at the cost of a pass over the board per node.
+   */
+  void EnableSymmetricKeys() noexcept { uses_symmetric_keys_ = true; }
+
+  /*
+   * Lets the search look up positions with few towers in the given
+   * tablebase instead of searching them. It must outlive the search.
+   */
+  void UseTablebase(const Tablebase<HEIGHT, WIDTH> *tablebase) noexcept {
+    tablebase_ = tablebase;
+  }
+
+  /*
+   * Lets the search report each completed iteration to the given callback.
+   * It must outlive the search.
+   */
+  void ReportProgressTo(const ProgressCallback *callback) noexcept {
+    progress_callback_ = callback;
+  }
+
+  // includes the root
+  [[nodiscard]] uint64_t num_explored_nodes() const noexcept {
+    return num_explored_nodes_;
+  }
+  [[nodiscard]] uint8_t max_explored_depth() const noexcept {
+    return max_explored_depth_;
+  }
+  // depth of the deepest iteration that completed, or 0 if there is none
+  [[nodiscard]] uint8_t completed_depth() const noexcept {
+    return completed_depth_;
+  }
+
+  /*
+   * Returns the expected line of play from the root that starts with the
+   * given move, see details::PrincipalVariationOf.
+   */
+  [[nodiscard]] std::vector<Move> PrincipalVariation(
+      const Move &best_move) noexcept {
+    return details::PrincipalVariationOf(
+        rules_, transposition_table_, board_, active_player_, best_move,
+        std::max<uint8_t>(completed_depth_, 1), uses_symmetric_keys_);
+  }
+  /*
+   * The final value of the game from the first player's point of view under
+   * optimal play by both players, if the deepest completed iteration searched
+   * the game tree completely.
+   */
+  [[nodiscard]] std::optional<game_value_t> proven_value() const noexcept {
+    if (completed_depth_ == 0 || root_reached_horizon_) {
+      return {};
+    }
+    return static_cast<game_value_t>(
+        active_player_ == Color::Blue ? root_value_ : -root_value_);
+  }
+
+ private:
+  const RULES &rules_;
+  TranspositionTable &transposition_table_;
+  Board<HEIGHT, WIDTH> board_;
+  const Color active_player_;
+  const Deadline &deadline_;
+  const std::atomic<bool> *stop_signal_;
+  details::Xorshift random_;
+  const bool shuffles_moves_;
+  // kept across iterations
+  MoveOrdering<HEIGHT, WIDTH> ordering_;
+  std::vector<PackedMove> root_moves_;
+  bool prunes_by_final_value_ = false;
+  bool uses_symmetric_keys_ = false;
+  const Tablebase<HEIGHT, WIDTH> *tablebase_ = nullptr;
+  const ProgressCallback *progress_callback_ = nullptr;
+  const clock::time_point start_;
+
+  uint64_t num_explored_nodes_ = 1;
+  uint8_t max_explored_depth_ = 0;
+  uint8_t completed_depth_ = 0;
+  // set once the search has to stop; all results are unusable from then on
+  bool aborted_ = false;
+  // whether some node was cut off by the depth limit rather than the end of
+  // the game
+  bool reached_horizon_ = false;
+  // results of the deepest completed iteration
+  int root_value_ = 0;
+  bool root_reached_horizon_ = true;
+
+  /*
+   * Returns the value of the board from the active player's point of view,
+   * looking ahead at most depth_left half-turns.
+   * Values outside of the (alpha, beta) window are only bounds of the true
+   * value.
+   */
+  int Negamax(Color active_player, uint8_t depth_left, uint8_t ply, int alpha,
+              int beta) noexcept;
+
+  /*
+   * Counts a visit of a node at the given ply and returns whether the search
+   * may go on.
+   */
+  bool CountNode(const uint8_t ply) noexcept {
+    ++num_explored_nodes_;
+    max_explored_depth_ = std::max(max_explored_depth_, ply);
+    if ((num_explored_nodes_ % details::NODES_BETWEEN_CLOCK_CHECKS == 0 &&
+         deadline_.HasPassed()) ||
+        (stop_signal_ != nullptr &&
+         stop_signal_->load(std::memory_order_relaxed))) {
+      aborted_ = true;
+    }
+    return not aborted_;
+  }
+
+  int Evaluate(const Color active_player) noexcept {
+    const int value = rules_.ComputeValueOf(board_);
+    return active_player == Color::Blue ? value : -value;
+  }
+
+  /*
+   * Searches the given moves of a node one half-turn above the horizon.
+   * Their positions are leaves, so they are all evaluated at once instead of
+   * making each move; they are visited in order nevertheless to count nodes
+   * and cut off exactly like the full search would.
+   */
+  void SearchLeaves(Color active_player, std::span<const PackedMove> moves,
+                    uint8_t ply, int &alpha, int beta, int &best_value,
+                    PackedMove &best_move) noexcept;
+
+  /*
+   * Randomly reorders the given moves.
+   */
+  void Shuffle(std::vector<PackedMove> &moves) noexcept {
+    for (auto index = moves.size(); index > 1; --index) {
+      std::swap(moves[index - 1], moves[random_() % index]);
+    }
+  }
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+std::optional<Move> AlphaBetaSearch<HEIGHT, WIDTH, RULES>::SearchRoot(
+    const uint8_t depth) noexcept {
+  reached_horizon_ = false;
+  auto best_move = PackedMove::Skip();
+  const auto opponent = details::OpponentOf(active_player_);
+  auto alpha = -details::SCORE_INFINITY;
+  if (root_moves_.empty()) {
+    // the root player has to skip, unless the game is over already
+    if (not rules_.HasLegalMoves(board_, opponent)) {
+      alpha = Evaluate(active_player_);
+    } else {
+      alpha = -Negamax(opponent, depth - 1, 1, -details::SCORE_INFINITY,
+                       details::SCORE_INFINITY);
+    }
+    if (aborted_) {
+      return {};
+    }
+  }
+  for (const auto move : root_moves_) {
+    board_.Make(move);
+    const auto rating =
+        -Negamax(opponent, depth - 1, 1, -details::SCORE_INFINITY, -alpha);
+    board_.Undo();
+    if (aborted_) {
+      return {};
+    }
+    if (rating > alpha) {
+      alpha = rating;
+      best_move = move;
+    }
+  }
+  if (!root_moves_.empty()) {
+    const auto [key, symmetry] =
+        details::TableKeyOf(board_, active_player_, uses_symmetric_keys_);
+    transposition_table_.Store(
+        key, {static_cast<int16_t>(alpha),
+              reached_horizon_ ? depth : PROVEN_DEPTH, Bound::Exact,
+              Transform<HEIGHT, WIDTH>(UnpackMove<HEIGHT, WIDTH>(best_move),
+                                       symmetry)});
+  }
+  completed_depth_ = depth;
+  root_value_ = alpha;
+  root_reached_horizon_ = reached_horizon_;
+  if (progress_callback_ != nullptr) {
+    (*progress_callback_)(details::ProgressOf(
+        depth,
+        static_cast<int16_t>(active_player_ == Color::Blue ? alpha : -alpha),
+        PrincipalVariation(UnpackMove<HEIGHT, WIDTH>(best_move)),
+        num_explored_nodes_, start_));
+  }
+  return UnpackMove<HEIGHT, WIDTH>(best_move);
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+Move AlphaBetaSearch<HEIGHT, WIDTH, RULES>::IterativelyDeepen(
+    const uint8_t first_depth, const uint8_t max_depth) noexcept {
+  if (shuffles_moves_) {
+    Shuffle(root_moves_);
+  }
+
+  // better than nothing if not even the first iteration completes
+  auto best_move = root_moves_.empty()
+                       ? Move::Skip()
+                       : UnpackMove<HEIGHT, WIDTH>(root_moves_.front());
+  // the deepest search still distinguishable from a proven one
+  const auto last_depth = std::min<uint8_t>(max_depth, PROVEN_DEPTH - 1);
+  for (auto depth = std::max<uint8_t>(first_depth, 1); depth <= last_depth;
+       ++depth) {
+    if (depth > first_depth && deadline_.HasPassed()) {
+      break;
+    }
+    ordering_.NewIteration();
+    const auto iteration_best_move = SearchRoot(depth);
+    if (not iteration_best_move.has_value()) {
+      break;
+    }
+    best_move = iteration_best_move.value();
+    if (not reached_horizon_) {
+      break;
+    }
+    // searching the previous best move first makes ties stable across
+    // iterations
+    details::MoveToFront(root_moves_, PackMove<HEIGHT, WIDTH>(best_move));
+  }
+  return best_move;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+int AlphaBetaSearch<HEIGHT, WIDTH, RULES>::Negamax(const Color active_player,
+                                                   const uint8_t depth_left,
+                                                   const uint8_t ply, int alpha,
+                                                   const int beta) noexcept {
+  if (not CountNode(ply)) {
+    return 0;
+  }
+
+  if (tablebase_ != nullptr) {
+    // an exact final value, so it does not reach the horizon
+    if (const auto value = tablebase_->Probe(board_, active_player)) {
+      return active_player == Color::Blue ? value.value() : -value.value();
+    }
+  }
+
+  if (depth_left == 0) {
+    reached_horizon_ = true;
+    return Evaluate(active_player);
+  }
+
+  const auto [key, symmetry] =
+      details::TableKeyOf(board_, active_player, uses_symmetric_keys_);
+  auto hash_move = PackedMove::Skip();
+  if (const auto entry = transposition_table_.Probe(key)) {
+    hash_move = PackMove<HEIGHT, WIDTH>(
+        Transform<HEIGHT, WIDTH>(entry->best_move, InverseOf(symmetry)));
+    const int score = entry->score;
+    if (entry->depth >= depth_left &&
+        (entry->bound == Bound::Exact ||
+         (entry->bound == Bound::Lower && score >= beta) ||
+         (entry->bound == Bound::Upper && score <= alpha))) {
+      reached_horizon_ |= entry->depth != PROVEN_DEPTH;
+      return score;
+    }
+  }
+
+  if (prunes_by_final_value_) {
+    // The static evaluation of any position reachable from here lies within
+    // these bounds, so pruning on them is safe even at limited depth.
+    const auto [blue_lower, blue_upper] = rules_.BoundFinalValueOf(board_);
+    const int lower = active_player == Color::Blue ? blue_lower : -blue_upper;
+    const int upper = active_player == Color::Blue ? blue_upper : -blue_lower;
+    if (lower >= beta || lower == upper) {
+      return lower;
+    }
+    if (upper <= alpha) {
+      return upper;
+    }
+  }
+
+  // Tracks whether this node's subtree alone reaches the horizon, in which
+  // case its value is not proven.
+  const auto outer_reached_horizon = reached_horizon_;
+  reached_horizon_ = false;
+  const auto original_alpha = alpha;
+  const auto opponent = details::OpponentOf(active_player);
+  auto best_value = -details::SCORE_INFINITY;
+  auto best_move = PackedMove::Skip();
+  auto bound = Bound::Exact;
+
+  StagedMoves<HEIGHT, WIDTH, RULES> possible_moves(
+      rules_, ordering_, board_, active_player, hash_move, ply);
+  if (not possible_moves.HasAny()) {
+    // The game is over if the opponent can not move either, in which case
+    // the static evaluation is the final score.
+    if (not rules_.HasLegalMoves(board_, opponent)) {
+      best_value = Evaluate(active_player);
+    } else {
+      // a player without legal moves has to skip the turn
+      best_value = -Negamax(opponent, depth_left - 1, ply + 1, -beta, -alpha);
+      bound = best_value <= original_alpha ? Bound::Upper
+              : best_value >= beta         ? Bound::Lower
+                                           : Bound::Exact;
+    }
+  } else if (depth_left == 1 && tablebase_ == nullptr) {
+    SearchLeaves(active_player, possible_moves.All(), ply, alpha, beta,
+                 best_value, best_move);
+    bound = best_value <= original_alpha ? Bound::Upper
+            : best_value >= beta         ? Bound::Lower
+                                         : Bound::Exact;
+  } else {
+    while (const auto next_move = possible_moves.Next()) {
+      const auto move = next_move.value();
+      board_.Make(move);
+      const auto value =
+          -Negamax(opponent, depth_left - 1, ply + 1, -beta, -alpha);
+      board_.Undo();
+      if (value > best_value) {
+        best_value = value;
+        best_move = move;
+      }
+      alpha = std::max(alpha, value);
+      if (alpha >= beta) {
+        ordering_.RecordCutoff(board_, move, ply, depth_left);
+        break;
+      }
+    }
+    bound = best_value <= original_alpha ? Bound::Upper
+            : best_value >= beta         ? Bound::Lower
+                                         : Bound::Exact;
+  }
+
+  if (aborted_) {
+    return 0;
+  }
+  transposition_table_.Store(
+      key, {static_cast<int16_t>(best_value),
+            reached_horizon_ ? depth_left : PROVEN_DEPTH, bound,
+            Transform<HEIGHT, WIDTH>(UnpackMove<HEIGHT, WIDTH>(best_move),
+                                     symmetry)});
+  reached_horizon_ |= outer_reached_horizon;
+  return best_value;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+void AlphaBetaSearch<HEIGHT, WIDTH, RULES>::SearchLeaves(
+    const Color active_player, const std::span<const PackedMove> moves,
+    const uint8_t ply, int &alpha, const int beta, int &best_value,
+    PackedMove &best_move) noexcept {
+  std::array<game_value_t, MoveList<HEIGHT, WIDTH>::CAPACITY> values;
+  rules_.ComputeValuesAfter(board_, moves, values);
+  reached_horizon_ = true;
+  for (std::size_t index = 0; index < moves.size(); ++index) {
+    if (not CountNode(ply + 1)) {
+      return;
+    }
+    const int value =
+        active_player == Color::Blue ? values[index] : -values[index];
+    if (value > best_value) {
+      best_value = value;
+      best_move = moves[index];
+    }
+    alpha = std::max(alpha, value);
+    if (alpha >= beta) {
+      ordering_.RecordCutoff(board_, moves[index], ply, 1);
+      return;
+    }
+  }
+}
+}  // namespace libsanjego
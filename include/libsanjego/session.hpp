@@ -0,0 +1,136 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "libsanjego/bot.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/types.hpp"
+
+namespace libsanjego {
+/*
+ * Sessions are available for all boards with at most this many rows and
+ * columns, which is the largest size SearchResult supports.
+ */
+constexpr board_size_t MAX_SESSION_HEIGHT = 15;
+constexpr board_size_t MAX_SESSION_WIDTH = 17;
+
+/*
+ * Memory a session gives its transposition table or Monte-Carlo tree unless
+ * told otherwise.
+ */
+constexpr std::size_t DEFAULT_SESSION_MEMORY_IN_MB = 16;
+
+/*
+ * The explorer a session searches with.
+ */
+enum class Engine : uint8_t {
+  // FullExplorer, an iteratively deepening alpha-beta search
+  AlphaBeta,
+  // MctsExplorer, which suits big boards better
+  MonteCarlo,
+};
+
+/*
+ * A game on a board whose size is only known at runtime.
+ * The board, rules and explorer of each supported size are compiled into the
+ * library ahead of time, so a session searches exactly as fast as the
+ * templates it hides. Only the calls to the session itself are virtual, and
+ * there is one of them per move or search rather than per node.
+ */
+class Session {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+  virtual ~Session() = default;
+
+  [[nodiscard]] virtual board_size_t height() const noexcept = 0;
+  [[nodiscard]] virtual board_size_t width() const noexcept = 0;
+  /*
+   * The player whose turn it is. Blue moves first.
+   */
+  [[nodiscard]] virtual Color active_player() const noexcept = 0;
+
+  [[nodiscard]] virtual std::optional<Tower> GetTowerAt(
+      Position position) const noexcept = 0;
+
+  /*
+   * Returns the moves the active player can make, which are none if they
+   * have to skip their turn.
+   */
+  [[nodiscard]] virtual std::vector<Move> GetLegalMoves() const noexcept = 0;
+
+  /*
+   * Makes the given move for the active player and passes the turn on.
+   * A skip is only accepted if the player has no legal move but the game is
+   * not over yet.
+   * Returns whether the move was made.
+   */
+  virtual bool Make(Move move) noexcept = 0;
+
+  /*
+   * Returns whether neither player can move anymore.
+   */
+  [[nodiscard]] virtual bool IsOver() const noexcept = 0;
+
+  /*
+   * Returns the value of the board from the first player's point of view,
+   * see StandardRuleset::ComputeValueOf.
+   */
+  [[nodiscard]] virtual game_value_t value() const noexcept = 0;
+
+  /*
+   * Searches for the best move of the active player with the explorer's
+   * default depth or number of playouts.
+   */
+  virtual SearchResult Explore() noexcept = 0;
+
+  /*
+   * Searches for the best move of the active player for the given amount of
+   * time.
+   */
+  virtual SearchResult Explore(clock::duration budget) noexcept = 0;
+};
+
+/*
+ * Starts a session on a new board of the given size that searches with the
+ * given engine. Returns nullptr if the size is not supported.
+ */
+std::unique_ptr<Session> CreateSession(
+    board_size_t height, board_size_t width, Engine engine = Engine::AlphaBeta,
+    std::size_t memory_in_mb = DEFAULT_SESSION_MEMORY_IN_MB) noexcept;
+
+namespace details {
+/*
+ * Creates the session of one board size. It is explicitly instantiated for
+ * all supported sizes in translation units that CMake generates from
+ * src/session_sizes.cpp.in, one per number of rows.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+std::unique_ptr<Session> CreateSessionOf(Engine engine,
+                                         std::size_t memory_in_mb) noexcept;
+}  // namespace details
+}  // namespace libsanjego
@@ -0,0 +1,220 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/types.hpp"
+
+namespace libsanjego {
+/*
+ * Number of ways to map a board onto itself by rotating and mirroring it:
+ * all 8 symmetries of a square for square boards, but only the identity,
+ * both mirrorings and the half turn for other rectangles.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+inline constexpr uint8_t NUM_SYMMETRIES = HEIGHT == WIDTH ? 8 : 4;
+
+/*
+ * A rotation or mirroring of a board, possibly combined with swapping the
+ * colors of all towers.
+ * Swapping the colors along with the player to move turns a position into
+ * one that is just as good for the player to move, so both are equivalent.
+ */
+struct Symmetry {
+  // bit 0 mirrors the columns, bit 1 the rows, and bit 2 transposes the
+  // board afterwards, which is only possible for square boards
+  uint8_t transform;
+  bool swaps_colors;
+
+  bool operator==(const Symmetry &other) const noexcept = default;
+};
+
+namespace details {
+/*
+ * For each transform, the field every field is mapped to.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+constexpr auto GenerateSymmetryPermutations() noexcept {
+  std::array<std::array<uint8_t, HEIGHT * WIDTH>,
+             NUM_SYMMETRIES<HEIGHT, WIDTH>>
+      permutations{};
+  for (uint8_t transform = 0; transform < permutations.size(); ++transform) {
+    for (uint32_t row = 0; row < HEIGHT; ++row) {
+      for (uint32_t column = 0; column < WIDTH; ++column) {
+        auto target_row = (transform & 2) != 0 ? HEIGHT - 1 - row : row;
+        auto target_column = (transform & 1) != 0 ? WIDTH - 1 - column : column;
+        if ((transform & 4) != 0) {
+          std::swap(target_row, target_column);
+        }
+        permutations[transform][row * WIDTH + column] =
+            static_cast<uint8_t>(target_row * WIDTH + target_column);
+      }
+    }
+  }
+  return permutations;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+inline constexpr auto SYMMETRY_PERMUTATIONS =
+    GenerateSymmetryPermutations<HEIGHT, WIDTH>();
+
+/*
+ * For each transform, the field every field is mapped from.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+constexpr auto InvertSymmetryPermutations() noexcept {
+  auto inverses = SYMMETRY_PERMUTATIONS<HEIGHT, WIDTH>;
+  for (uint8_t transform = 0; transform < inverses.size(); ++transform) {
+    for (uint32_t field = 0; field < HEIGHT * WIDTH; ++field) {
+      inverses[transform]
+              [SYMMETRY_PERMUTATIONS<HEIGHT, WIDTH>[transform][field]] =
+                  static_cast<uint8_t>(field);
+    }
+  }
+  return inverses;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+inline constexpr auto INVERSE_SYMMETRY_PERMUTATIONS =
+    InvertSymmetryPermutations<HEIGHT, WIDTH>();
+
+/*
+ * Orders towers by height first and color second, with empty fields first.
+ */
+inline uint32_t SortKeyOf(const Tower &tower, const bool swaps_colors) noexcept {
+  const auto height = tower.height();
+  if (height == 0) {
+    return 0;
+  }
+  return uint32_t{height} << 1 |
+         (static_cast<uint32_t>(tower.top()) ^ (swaps_colors ? 1 : 0));
+}
+}  // namespace details
+
+/*
+ * Returns the symmetry that maps the given position to the representative
+ * of all positions equivalent to it. The representative always has the
+ * first player to move, and among the rotations and mirrorings it is the
+ * one whose fields compare smallest row by row.
+ * Comparisons stop at the first differing field, which is usually one of the
+ * first few.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+Symmetry FindCanonicalSymmetry(const Board<HEIGHT, WIDTH> &board,
+                               const Color active_player) noexcept {
+  const auto swaps_colors = active_player == Color::Yellow;
+  const auto fields = board.fields();
+  const auto &inverses = details::INVERSE_SYMMETRY_PERMUTATIONS<HEIGHT, WIDTH>;
+  uint8_t best = 0;
+  for (uint8_t transform = 1; transform < NUM_SYMMETRIES<HEIGHT, WIDTH>;
+       ++transform) {
+    for (uint32_t field = 0; field < HEIGHT * WIDTH; ++field) {
+      const auto candidate =
+          details::SortKeyOf(fields[inverses[transform][field]], swaps_colors);
+      const auto current =
+          details::SortKeyOf(fields[inverses[best][field]], swaps_colors);
+      if (candidate != current) {
+        if (candidate < current) {
+          best = transform;
+        }
+        break;
+      }
+    }
+  }
+  return {best, swaps_colors};
+}
+
+/*
+ * Returns the symmetry that undoes the given one.
+ */
+constexpr Symmetry InverseOf(const Symmetry symmetry) noexcept {
+  // Transposing after mirroring is the same as mirroring the other axis
+  // before transposing.
+  auto transform = symmetry.transform;
+  if ((transform & 4) != 0) {
+    transform = 4 | (transform & 1) << 1 | (transform & 2) >> 1;
+  }
+  return {transform, symmetry.swaps_colors};
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+Board<HEIGHT, WIDTH> Transform(const Board<HEIGHT, WIDTH> &board,
+                               const Symmetry symmetry) noexcept {
+  return board.Permuted(
+      details::SYMMETRY_PERMUTATIONS<HEIGHT, WIDTH>[symmetry.transform],
+      symmetry.swaps_colors);
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+Position Transform(const Position position, const Symmetry symmetry) noexcept {
+  const auto field =
+      details::SYMMETRY_PERMUTATIONS<HEIGHT, WIDTH>[symmetry.transform]
+                                                   [position.row * WIDTH +
+                                                    position.column];
+  return {board_size_t(field / WIDTH), board_size_t(field % WIDTH)};
+}
+
+/*
+ * Skips are left as they are.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+Move Transform(const Move &move, const Symmetry symmetry) noexcept {
+  if (move.IsSkip()) {
+    return move;
+  }
+  return {Transform<HEIGHT, WIDTH>(move.source, symmetry),
+          Transform<HEIGHT, WIDTH>(move.target, symmetry),
+          move.affected_tower};
+}
+
+struct CanonicalKey {
+  // the Zobrist hash of the representative
+  uint64_t hash;
+  // maps the position to the representative
+  Symmetry symmetry;
+};
+
+/*
+ * Returns a key that all equivalent positions share, computed without
+ * building the representative board.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+CanonicalKey CanonicalKeyOf(const Board<HEIGHT, WIDTH> &board,
+                            const Color active_player) noexcept {
+  const auto symmetry = FindCanonicalSymmetry(board, active_player);
+  const auto &permutation =
+      details::SYMMETRY_PERMUTATIONS<HEIGHT, WIDTH>[symmetry.transform];
+  const auto fields = board.fields();
+  uint64_t hash = 0;
+  for (uint32_t field = 0; field < HEIGHT * WIDTH; ++field) {
+    // the same representation a Board uses for its hash
+    const auto representation =
+        details::SortKeyOf(fields[field], symmetry.swaps_colors);
+    if (representation != 0) {
+      hash ^= details::ZobristKeyOf<HEIGHT, WIDTH>(
+          permutation[field], static_cast<tower_size_t>(representation));
+    }
+  }
+  return {hash, symmetry};
+}
+}  // namespace libsanjego
@@ -0,0 +1,403 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/mapped_file.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/types.hpp"
+
+namespace libsanjego {
+/*
+ * The largest number of towers tablebases can be generated for. The size of
+ * a tablebase grows roughly with the (2 * max_towers - 1)-th power of the
+ * number of fields, so only small numbers are practical anyway.
+ */
+constexpr uint8_t MAX_TABLEBASE_TOWERS = 8;
+
+namespace details {
+constexpr std::array<char, 4> TABLEBASE_MAGIC{'S', 'J', 'T', 'B'};
+constexpr uint8_t TABLEBASE_VERSION = 2;
+
+/*
+ * Precedes the values of a tablebase file. Only bytes are stored, so the
+ * format does not depend on the byte order of the machine.
+ */
+struct TablebaseHeader {
+  std::array<char, 4> magic;
+  uint8_t version;
+  uint8_t height;
+  uint8_t width;
+  uint8_t max_towers;
+};
+static_assert(sizeof(TablebaseHeader) == 8);
+
+/*
+ * Binomial coefficients C(n, k) for all n of a board and the small k needed
+ * to rank positions with few towers.
+ */
+constexpr auto ComputeBinomials() noexcept {
+  std::array<std::array<uint64_t, MAX_TABLEBASE_TOWERS + 1>, 256> binomials{};
+  for (std::size_t n = 0; n < binomials.size(); ++n) {
+    binomials[n][0] = 1;
+    for (std::size_t k = 1; k <= MAX_TABLEBASE_TOWERS && n > 0; ++k) {
+      binomials[n][k] = binomials[n - 1][k - 1] + binomials[n - 1][k];
+    }
+  }
+  return binomials;
+}
+inline constexpr auto BINOMIALS = ComputeBinomials();
+
+/*
+ * A tower as far as a tablebase is concerned.
+ */
+struct PlacedTower {
+  uint8_t field;
+  tower_size_t height;
+  Color owner;
+};
+
+/*
+ * The towers of a position in ascending order of their fields.
+ */
+struct TowerList {
+  std::array<PlacedTower, MAX_TABLEBASE_TOWERS> towers;
+  uint8_t size;
+};
+
+/*
+ * Indexes positions with a fixed number of towers k on a board with n fields.
+ * A position is ranked by the set of occupied fields, the owners of their
+ * towers and the heights of the towers. Since every brick stays on the board,
+ * the heights are a composition of n into k parts, which maps to the set of
+ * its k - 1 partial sums. Both sets are ranked with the combinatorial number
+ * system. Each index is followed by the entry for the other player to move.
+ */
+constexpr uint64_t NumPositionsWith(const uint32_t num_fields,
+                                    const uint8_t num_towers) noexcept {
+  return (BINOMIALS[num_fields][num_towers] << num_towers) *
+         BINOMIALS[num_fields - 1][num_towers - 1];
+}
+
+constexpr uint64_t IndexOf(const TowerList &position,
+                           const uint32_t num_fields) noexcept {
+  uint64_t fields_rank = 0;
+  uint64_t owners = 0;
+  uint64_t heights_rank = 0;
+  uint32_t partial_sum = 0;
+  for (uint8_t index = 0; index < position.size; ++index) {
+    const auto &tower = position.towers[index];
+    fields_rank += BINOMIALS[tower.field][index + 1];
+    owners |= uint64_t{static_cast<uint8_t>(tower.owner)} << index;
+    partial_sum += tower.height;
+    // the last partial sum is always the number of fields
+    if (index + 1 < position.size) {
+      heights_rank += BINOMIALS[partial_sum - 1][index + 1];
+    }
+  }
+  return ((fields_rank << position.size) | owners) *
+             BINOMIALS[num_fields - 1][position.size - 1] +
+         heights_rank;
+}
+
+/*
+ * Returns the largest value below limit whose binomial coefficient with k
+ * does not exceed the rank.
+ */
+constexpr uint32_t UnrankElement(const uint64_t rank, const uint8_t k,
+                                 uint32_t limit) noexcept {
+  while (BINOMIALS[limit - 1][k] > rank) {
+    --limit;
+  }
+  return limit - 1;
+}
+
+/*
+ * Inverse of IndexOf.
+ */
+constexpr TowerList PositionAt(uint64_t index, const uint32_t num_fields,
+                               const uint8_t num_towers) noexcept {
+  TowerList position{};
+  position.size = num_towers;
+  const auto num_compositions = BINOMIALS[num_fields - 1][num_towers - 1];
+  auto heights_rank = index % num_compositions;
+  index /= num_compositions;
+  const auto owners = index & ((uint64_t{1} << num_towers) - 1);
+  auto fields_rank = index >> num_towers;
+
+  uint32_t field_limit = num_fields;
+  uint32_t partial_sum = num_fields;
+  for (uint8_t k = num_towers; k > 0; --k) {
+    auto &tower = position.towers[k - 1];
+    field_limit = UnrankElement(fields_rank, k, field_limit);
+    fields_rank -= BINOMIALS[field_limit][k];
+    tower.field = static_cast<uint8_t>(field_limit);
+    tower.owner = static_cast<Color>((owners >> (k - 1)) & 1);
+
+    // the partial sum before this tower, which is 0 for the first one
+    uint32_t previous_sum = 0;
+    if (k > 1) {
+      previous_sum = UnrankElement(heights_rank, k - 1, partial_sum - 1) + 1;
+      heights_rank -= BINOMIALS[previous_sum - 1][k - 1];
+    }
+    tower.height = static_cast<tower_size_t>(partial_sum - previous_sum);
+    partial_sum = previous_sum;
+  }
+  return position;
+}
+
+constexpr bool AreNeighbours(const uint8_t field, const uint8_t other,
+                             const board_size_t width) noexcept {
+  const auto row = field / width;
+  const auto column = field % width;
+  const auto other_row = other / width;
+  const auto other_column = other % width;
+  return (row == other_row && (column + 1 == other_column ||
+                               other_column + 1 == column)) ||
+         (column == other_column &&
+          (row + 1 == other_row || other_row + 1 == row));
+}
+
+/*
+ * Swapping the owners of all towers and the player to move negates the value
+ * of a position.
+ */
+inline TowerList WithSwappedOwners(TowerList position) noexcept {
+  for (uint8_t index = 0; index < position.size; ++index) {
+    auto &owner = position.towers[index].owner;
+    owner = owner == Color::Blue ? Color::Yellow : Color::Blue;
+  }
+  return position;
+}
+}  // namespace details
+
+/*
+ * Exact final values of all positions with up to a few towers left on a
+ * board of the given size, computed backwards from the end of the game.
+ *
+ * Tablebases are generated once with Generate and stored in a file that is
+ * mapped into memory when loaded again. Its values are then read in place,
+ * so loading is instant and the pages are shared between processes.
+ *
+ * File layout: an 8 byte header (magic "SJTB", version, height, width,
+ * maximum number of towers) followed by one game value byte per position with
+ * the first player to move, grouped by the number of towers in ascending
+ * order. Positions with the second player to move are looked up with the
+ * owners of all towers swapped.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+class Tablebase {
+ public:
+  static constexpr uint32_t NUM_FIELDS = HEIGHT * WIDTH;
+
+  /*
+   * Solves all positions with up to max_towers towers and writes them to the
+   * given path. Returns whether the file could be written.
+   * Memory and disk usage equal the number of bytes returned by FileSizeFor.
+   */
+  static bool Generate(const std::string &path, uint8_t max_towers) noexcept;
+
+  /*
+   * Maps a file written by Generate, or returns nothing if it does not exist
+   * or does not fit this board size.
+   */
+  static std::optional<Tablebase> Load(const std::string &path) noexcept;
+
+  static constexpr uint64_t FileSizeFor(uint8_t max_towers) noexcept {
+    return sizeof(details::TablebaseHeader) + OffsetOf(max_towers + 1);
+  }
+
+  /*
+   * Returns the final value of the game from the first player's point of
+   * view under optimal play, or nothing if there are too many towers left.
+   */
+  [[nodiscard]] std::optional<game_value_t> Probe(
+      const Board<HEIGHT, WIDTH> &board,
+      Color active_player) const noexcept;
+
+  [[nodiscard]] uint8_t max_towers() const noexcept { return max_towers_; }
+
+ private:
+  MappedFile file_;
+  const game_value_t *values_;
+  uint8_t max_towers_;
+
+  Tablebase(MappedFile file, const uint8_t max_towers) noexcept
+      : file_(std::move(file)),
+        values_(reinterpret_cast<const game_value_t *>(
+            file_.data() + sizeof(details::TablebaseHeader))),
+        max_towers_(max_towers) {}
+
+  // position of the first entry with the given number of towers
+  static constexpr uint64_t OffsetOf(const uint8_t num_towers) noexcept {
+    uint64_t offset = 0;
+    for (uint8_t k = 1; k < num_towers; ++k) {
+      offset += details::NumPositionsWith(NUM_FIELDS, k);
+    }
+    return offset;
+  }
+
+  // entry of the position with the first player to move
+  static constexpr uint64_t EntryOf(
+      const details::TowerList &position) noexcept {
+    return OffsetOf(position.size) + details::IndexOf(position, NUM_FIELDS);
+  }
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+bool Tablebase<HEIGHT, WIDTH>::Generate(const std::string &path,
+                                        uint8_t max_towers) noexcept {
+  max_towers = std::min<uint32_t>({max_towers, MAX_TABLEBASE_TOWERS,
+                                   NUM_FIELDS});
+  if (max_towers == 0) {
+    return false;
+  }
+  std::vector<game_value_t> values(OffsetOf(max_towers + 1));
+
+  // Every move removes a tower, so positions only depend on positions with
+  // fewer towers, or on the same position if a player has to skip.
+  for (uint8_t num_towers = 1; num_towers <= max_towers; ++num_towers) {
+    const auto num_positions =
+        details::NumPositionsWith(NUM_FIELDS, num_towers);
+    for (uint64_t index = 0; index < num_positions; ++index) {
+      const auto position =
+          details::PositionAt(index, NUM_FIELDS, num_towers);
+      // best value for each player from the first player's point of view
+      std::array<std::optional<int>, 2> best_values;
+      for (uint8_t source = 0; source < num_towers; ++source) {
+        const auto &moved = position.towers[source];
+        const auto player = static_cast<uint8_t>(moved.owner);
+        for (uint8_t target = 0; target < num_towers; ++target) {
+          if (not details::AreNeighbours(moved.field,
+                                         position.towers[target].field,
+                                         WIDTH)) {
+            continue;
+          }
+          details::TowerList child{};
+          for (uint8_t other = 0; other < num_towers; ++other) {
+            if (other == source) {
+              continue;
+            }
+            auto tower = position.towers[other];
+            if (other == target) {
+              tower.height += moved.height;
+              tower.owner = moved.owner;
+            }
+            child.towers[child.size++] = tower;
+          }
+          // the first player's moves leave the second player to move
+          const int value =
+              moved.owner == Color::Blue
+                  ? -values[EntryOf(details::WithSwappedOwners(child))]
+                  : values[EntryOf(child)];
+          auto &best_value = best_values[player];
+          if (not best_value.has_value() ||
+              (moved.owner == Color::Blue ? value > best_value.value()
+                                          : value < best_value.value())) {
+            best_value = value;
+          }
+        }
+      }
+
+      if (not best_values[0].has_value() && not best_values[1].has_value()) {
+        // the game is over
+        std::array<tower_size_t, 2> max_heights{0, 0};
+        for (uint8_t tower_index = 0; tower_index < num_towers;
+             ++tower_index) {
+          const auto &tower = position.towers[tower_index];
+          auto &max_height = max_heights[static_cast<uint8_t>(tower.owner)];
+          max_height = std::max(max_height, tower.height);
+        }
+        best_values[0] = max_heights[0] - max_heights[1];
+        best_values[1] = best_values[0];
+      }
+      // a first player without moves skips, leaving the position to the
+      // second player
+      const auto value = best_values[0].has_value() ? best_values[0].value()
+                                                    : best_values[1].value();
+      values[OffsetOf(num_towers) + index] = static_cast<game_value_t>(value);
+    }
+  }
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  const details::TablebaseHeader header{details::TABLEBASE_MAGIC,
+                                        details::TABLEBASE_VERSION, HEIGHT,
+                                        WIDTH, max_towers};
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(values.data()),
+             static_cast<std::streamsize>(values.size()));
+  return file.good();
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+std::optional<Tablebase<HEIGHT, WIDTH>> Tablebase<HEIGHT, WIDTH>::Load(
+    const std::string &path) noexcept {
+  auto file = MappedFile::Open(path);
+  if (not file.has_value() ||
+      file->size() < sizeof(details::TablebaseHeader)) {
+    return {};
+  }
+  details::TablebaseHeader header{};
+  std::memcpy(&header, file->data(), sizeof(header));
+  if (header.magic != details::TABLEBASE_MAGIC ||
+      header.version != details::TABLEBASE_VERSION ||
+      header.height != HEIGHT || header.width != WIDTH ||
+      header.max_towers == 0 || header.max_towers > MAX_TABLEBASE_TOWERS ||
+      file->size() != FileSizeFor(header.max_towers)) {
+    return {};
+  }
+  return Tablebase(std::move(file.value()), header.max_towers);
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+std::optional<game_value_t> Tablebase<HEIGHT, WIDTH>::Probe(
+    const Board<HEIGHT, WIDTH> &board,
+    const Color active_player) const noexcept {
+  if (board.num_towers() > max_towers_) {
+    return {};
+  }
+  details::TowerList position{};
+  for (board_size_t row = 0; row < HEIGHT; ++row) {
+    for (board_size_t col = 0; col < WIDTH; ++col) {
+      const auto tower = board.GetTowerAt(Position{row, col});
+      if (tower.has_value()) {
+        position.towers[position.size++] = {
+            static_cast<uint8_t>(row * WIDTH + col), tower->height(),
+            tower->top()};
+      }
+    }
+  }
+  if (active_player == Color::Yellow) {
+    return static_cast<game_value_t>(
+        -values_[EntryOf(details::WithSwappedOwners(position))]);
+  }
+  return values_[EntryOf(position)];
+}
+}  // namespace libsanjego
@@ -0,0 +1,123 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <optional>
+
+#include "libsanjego/gameobjects.hpp"
+
+namespace libsanjego {
+/*
+ * Describes how a stored score relates to the true value of a position.
+ */
+enum struct Bound : uint8_t { None = 0, Exact = 1, Lower = 2, Upper = 3 };
+
+/*
+ * Marks entries whose subtree was searched to the end of the game, so that
+ * their score is valid for any remaining depth.
+ */
+constexpr uint8_t PROVEN_DEPTH = std::numeric_limits<uint8_t>::max();
+
+struct TranspositionEntry {
+  int16_t score;
+  // remaining half-turns the score was computed with
+  uint8_t depth;
+  Bound bound;
+  // a skip move if none is known
+  Move best_move;
+};
+
+struct TranspositionStatistics {
+  uint64_t hits;
+  uint64_t misses;
+  // number of stores that found the slot occupied by another position
+  uint64_t collisions;
+};
+
+/*
+ * Returns the key of a position in a transposition table, which also depends
+ * on the player to move.
+ */
+constexpr uint64_t KeyOf(const uint64_t board_hash,
+                         const Color active_player) noexcept {
+  return active_player == Color::Blue ? board_hash
+                                      : board_hash ^ 0xC3A5C85C97CB3127ULL;
+}
+
+/*
+ * A fixed-size hash table caching search results of positions.
+ *
+ * It is safe to probe and store from many threads without locks: each slot
+ * stores its data word along with the data xor-ed with the key. A slot that
+ * is torn by concurrent writes fails this check and is treated as empty.
+ *
+ * When two positions compete for a slot, the one searched deeper is kept,
+ * unless the slot was written during an earlier search.
+ */
+class TranspositionTable {
+ public:
+  /*
+   * Creates a table that occupies at most the given number of megabytes,
+   * but has at least one slot.
+   */
+  explicit TranspositionTable(std::size_t size_in_mb);
+
+  [[nodiscard]] std::optional<TranspositionEntry> Probe(uint64_t key) noexcept;
+  void Store(uint64_t key, const TranspositionEntry &entry) noexcept;
+
+  /*
+   * Ages all entries so that they are replaced in favour of new ones.
+   * Should be called before each search.
+   */
+  void NewSearch() noexcept;
+  void Clear() noexcept;
+
+  [[nodiscard]] std::size_t capacity() const noexcept { return mask_ + 1; }
+  [[nodiscard]] TranspositionStatistics statistics() const noexcept;
+
+ private:
+  struct Slot {
+    std::atomic<uint64_t> checksum;
+    std::atomic<uint64_t> data;
+  };
+  // Counters are spread over several cache lines so that threads rarely
+  // contend for the same one.
+  struct alignas(64) CounterShard {
+    std::atomic<uint64_t> hits;
+    std::atomic<uint64_t> misses;
+    std::atomic<uint64_t> collisions;
+  };
+  static constexpr std::size_t NUM_COUNTER_SHARDS = 16;
+
+  std::unique_ptr<Slot[]> slots_;
+  std::size_t mask_;
+  std::atomic<uint8_t> generation_ = 0;
+  std::array<CounterShard, NUM_COUNTER_SHARDS> counters_;
+
+  CounterShard &CountersFor(const uint64_t key) noexcept {
+    return counters_[(key >> 32) % NUM_COUNTER_SHARDS];
+  }
+};
+}  // namespace libsanjego
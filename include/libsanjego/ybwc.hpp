@@ -0,0 +1,585 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "libsanjego/deadline.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/ordering.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/scheduler.hpp"
+#include "libsanjego/search.hpp"
+#include "libsanjego/tablebase.hpp"
+#include "libsanjego/transposition.hpp"
+#include "libsanjego/types.hpp"
+
+namespace libsanjego {
+/*
+ * Nodes with fewer remaining half-turns are searched serially, as their
+ * subtrees are too small to be worth a task.
+ */
+constexpr uint8_t MIN_SPLIT_DEPTH = 3;
+
+/*
+ * An alpha-beta search that is parallelized with the Young Brothers Wait
+ * Concept: at each node, the first move is searched serially, and only if it
+ * does not cause a cutoff, the remaining moves are spread over the workers of
+ * a work-stealing scheduler. As soon as one of these sibling tasks causes a
+ * cutoff, the others are aborted.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH,
+          Ruleset<HEIGHT, WIDTH> RULES = StandardRuleset<HEIGHT, WIDTH>>
+class YbwcSearch {
+ public:
+  typedef std::chrono::steady_clock clock;
+
+  YbwcSearch(const RULES &rules, TranspositionTable &transposition_table,
+             WorkStealingScheduler &scheduler,
+             const Board<HEIGHT, WIDTH> &board, Color active_player,
+             const Deadline &deadline)
+      : rules_(rules),
+        transposition_table_(transposition_table),
+        scheduler_(scheduler),
+        board_(board),
+        active_player_(active_player),
+        deadline_(deadline),
+        root_moves_(rules.GetLegalPackedMoves(board, active_player)),
+        statistics_(scheduler.num_workers()),
+        orderings_(scheduler.num_workers()),
+        start_(clock::now()) {
+    orderings_.front().Order(root_moves_, board_, PackedMove::Skip(), 0);
+  }
+
+  /*
+   * Searches all root moves to the given depth and returns the best of them,
+   * or nothing if the search was aborted before it completed.
+   * Among equally good moves, the one listed first wins.
+   */
+  std::optional<Move> SearchRoot(uint8_t depth) noexcept;
+
+  /*
+   * Deepens the search one half-turn at a time until max_depth is reached,
+   * the deadline has passed, or the game tree has been searched completely.
+   * Returns the best move of the deepest completed iteration. If there is
+   * none, this is the first legal move or a skip if there is no such move.
+   */
+  Move IterativelyDeepen(uint8_t max_depth) noexcept;
+
+  /*
+   * Lets the search look up positions with few towers in the given
+   * tablebase instead of searching them. It must outlive the search.
+   */
+  void UseTablebase(const Tablebase<HEIGHT, WIDTH> *tablebase) noexcept {
+    tablebase_ = tablebase;
+  }
+
+  /*
+   * Lets all positions that are equivalent by symmetry share their entry in
+   * the transposition table.
+   */
+  void EnableSymmetricKeys() noexcept { uses_symmetric_keys_ = true; }
+
+  /*
+   * Lets the search report each completed iteration to the given callback.
+   * It must outlive the search.
+   */
+  void ReportProgressTo(const ProgressCallback *callback) noexcept {
+    progress_callback_ = callback;
+  }
+
+  // includes the root
+  [[nodiscard]] uint64_t num_explored_nodes() const noexcept;
+  [[nodiscard]] uint8_t max_explored_depth() const noexcept;
+  // depth of the last iteration that completed, or 0 if there is none
+  [[nodiscard]] uint8_t completed_depth() const noexcept {
+    return completed_depth_;
+  }
+
+  /*
+   * Returns the expected line of play from the root that starts with the
+   * given move, see details::PrincipalVariationOf.
+   */
+  [[nodiscard]] std::vector<Move> PrincipalVariation(
+      const Move &best_move) noexcept {
+    return details::PrincipalVariationOf(
+        rules_, transposition_table_, board_, active_player_, best_move,
+        std::max<uint8_t>(completed_depth_, 1), uses_symmetric_keys_);
+  }
+  /*
+   * The final value of the game from the first player's point of view under
+   * optimal play by both players, if the last iteration searched the game
+   * tree completely.
+   */
+  [[nodiscard]] std::optional<game_value_t> proven_value() const noexcept {
+    if (not searched_completely_) {
+      return {};
+    }
+    return static_cast<game_value_t>(
+        active_player_ == Color::Blue ? root_value_ : -root_value_);
+  }
+
+ private:
+  /*
+   * A node whose remaining moves are searched by parallel tasks.
+   */
+  struct SplitPoint {
+    const SplitPoint *parent;
+    const int beta;
+    std::atomic<int> alpha;
+    std::atomic<bool> cutoff = false;
+    std::atomic<std::size_t> num_pending_tasks;
+    // whether all completed children were searched to the end of the game
+    std::atomic<bool> proven = true;
+    std::mutex mutex;
+    int best_value = -details::SCORE_INFINITY;
+    std::size_t best_index = 0;
+
+    SplitPoint(const SplitPoint *parent, int alpha, int beta,
+               std::size_t num_tasks)
+        : parent(parent),
+          beta(beta),
+          alpha(alpha),
+          num_pending_tasks(num_tasks) {}
+
+    /*
+     * Whether this node or one of its ancestors was cut off, making the
+     * search of its subtree pointless.
+     */
+    [[nodiscard]] bool IsAborted() const noexcept {
+      for (auto node = this; node != nullptr; node = node->parent) {
+        if (node->cutoff.load(std::memory_order_relaxed)) {
+          return true;
+        }
+      }
+      return false;
+    }
+  };
+
+  // each worker only writes to its own slot
+  struct alignas(64) WorkerStatistics {
+    std::atomic<uint64_t> num_explored_nodes = 0;
+    std::atomic<uint8_t> max_explored_depth = 0;
+  };
+
+  const RULES &rules_;
+  TranspositionTable &transposition_table_;
+  WorkStealingScheduler &scheduler_;
+  const Board<HEIGHT, WIDTH> board_;
+  const Color active_player_;
+  const Deadline &deadline_;
+  std::vector<PackedMove> root_moves_;
+  std::vector<WorkerStatistics> statistics_;
+  // each worker only uses its own, and keeps it across iterations
+  std::vector<MoveOrdering<HEIGHT, WIDTH>> orderings_;
+  const Tablebase<HEIGHT, WIDTH> *tablebase_ = nullptr;
+  bool uses_symmetric_keys_ = false;
+  const ProgressCallback *progress_callback_ = nullptr;
+  const clock::time_point start_;
+  // set once the deadline has passed; all results are unusable from then on
+  std::atomic<bool> stopped_ = false;
+  // whether the last iteration reached the end of the game in all lines
+  bool searched_completely_ = false;
+  uint8_t completed_depth_ = 0;
+  int root_value_ = 0;
+
+  [[nodiscard]] bool IsAborted(const SplitPoint *split_point) const noexcept {
+    return stopped_.load(std::memory_order_relaxed) ||
+           (split_point != nullptr && split_point->IsAborted());
+  }
+
+  /*
+   * Returns the value of the board from the active player's point of view,
+   * looking ahead at most depth_left half-turns. The flag proven tells
+   * whether the value was computed without reaching the depth limit.
+   * The split point is the closest ancestor whose siblings are searched in
+   * parallel.
+   */
+  int Negamax(Board<HEIGHT, WIDTH> &board, Color active_player,
+              uint8_t depth_left, uint8_t ply, int alpha, int beta,
+              const SplitPoint *split_point, bool &proven) noexcept;
+
+  /*
+   * Searches moves[1..] in parallel tasks after moves[0] did not cause a
+   * cutoff and updates best_value and best_index accordingly.
+   */
+  void SearchSiblings(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                      std::span<const PackedMove> moves, uint8_t depth_left,
+                      uint8_t ply, int alpha, int beta,
+                      const SplitPoint *split_point, int &best_value,
+                      std::size_t &best_index, bool &proven) noexcept;
+
+  void CountNode(uint8_t ply) noexcept;
+
+  /*
+   * Searches the given moves of a node one half-turn above the horizon.
+   * Their positions are leaves, so they are all evaluated at once instead of
+   * making each move; they are visited in order nevertheless to count nodes
+   * and cut off exactly like the full search would.
+   */
+  void SearchLeaves(const Board<HEIGHT, WIDTH> &board, Color active_player,
+                    std::span<const PackedMove> moves, uint8_t ply,
+                    int &alpha, int beta, const SplitPoint *split_point,
+                    int &best_value, std::size_t &best_index) noexcept;
+
+  int Evaluate(const Board<HEIGHT, WIDTH> &board,
+               const Color active_player) noexcept {
+    const int value = rules_.ComputeValueOf(board);
+    return active_player == Color::Blue ? value : -value;
+  }
+};
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+std::optional<Move> YbwcSearch<HEIGHT, WIDTH, RULES>::SearchRoot(
+    const uint8_t depth) noexcept {
+  if (root_moves_.empty()) {
+    return Move::Skip();
+  }
+  CountNode(0);
+  auto board = board_;
+  const auto opponent = details::OpponentOf(active_player_);
+  bool proven = true;
+  board.Make(root_moves_.front());
+  auto best_value =
+      -Negamax(board, opponent, depth - 1, 1, -details::SCORE_INFINITY,
+               details::SCORE_INFINITY, nullptr, proven);
+  board.Undo();
+  std::size_t best_index = 0;
+  if (root_moves_.size() > 1) {
+    SearchSiblings(board, active_player_, root_moves_, depth, 0, best_value,
+                   details::SCORE_INFINITY, nullptr, best_value, best_index,
+                   proven);
+  }
+  if (IsAborted(nullptr)) {
+    return {};
+  }
+  const auto best_move = UnpackMove<HEIGHT, WIDTH>(root_moves_[best_index]);
+  const auto [key, symmetry] =
+      details::TableKeyOf(board_, active_player_, uses_symmetric_keys_);
+  transposition_table_.Store(key, {static_cast<int16_t>(best_value),
+                                   proven ? PROVEN_DEPTH : depth, Bound::Exact,
+                                   Transform<HEIGHT, WIDTH>(best_move,
+                                                            symmetry)});
+  searched_completely_ = proven;
+  completed_depth_ = depth;
+  root_value_ = best_value;
+  if (progress_callback_ != nullptr) {
+    (*progress_callback_)(details::ProgressOf(
+        depth,
+        static_cast<int16_t>(active_player_ == Color::Blue ? best_value
+                                                           : -best_value),
+        PrincipalVariation(best_move), num_explored_nodes(), start_));
+  }
+  return best_move;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+Move YbwcSearch<HEIGHT, WIDTH, RULES>::IterativelyDeepen(
+    const uint8_t max_depth) noexcept {
+  if (root_moves_.empty()) {
+    CountNode(0);
+    return Move::Skip();
+  }
+  // better than nothing if not even the first iteration completes
+  auto best_move = UnpackMove<HEIGHT, WIDTH>(root_moves_.front());
+  const auto last_depth = std::min<uint8_t>(max_depth, PROVEN_DEPTH - 1);
+  for (uint8_t depth = 1; depth <= last_depth; ++depth) {
+    if (depth > 1 && deadline_.HasPassed()) {
+      break;
+    }
+    for (auto &ordering : orderings_) {
+      ordering.NewIteration();
+    }
+    const auto iteration_best_move = SearchRoot(depth);
+    if (not iteration_best_move.has_value()) {
+      break;
+    }
+    best_move = iteration_best_move.value();
+    if (searched_completely_) {
+      break;
+    }
+    details::MoveToFront(root_moves_, PackMove<HEIGHT, WIDTH>(best_move));
+  }
+  return best_move;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+int YbwcSearch<HEIGHT, WIDTH, RULES>::Negamax(Board<HEIGHT, WIDTH> &board,
+                                              const Color active_player,
+                                              const uint8_t depth_left,
+                                              const uint8_t ply, int alpha,
+                                              const int beta,
+                                              const SplitPoint *split_point,
+                                              bool &proven) noexcept {
+  CountNode(ply);
+  if (IsAborted(split_point)) {
+    return 0;
+  }
+
+  if (tablebase_ != nullptr) {
+    if (const auto value = tablebase_->Probe(board, active_player)) {
+      return active_player == Color::Blue ? value.value() : -value.value();
+    }
+  }
+
+  if (depth_left == 0) {
+    proven = false;
+    return Evaluate(board, active_player);
+  }
+
+  const auto [key, symmetry] =
+      details::TableKeyOf(board, active_player, uses_symmetric_keys_);
+  auto hash_move = PackedMove::Skip();
+  if (const auto entry = transposition_table_.Probe(key)) {
+    hash_move = PackMove<HEIGHT, WIDTH>(
+        Transform<HEIGHT, WIDTH>(entry->best_move, InverseOf(symmetry)));
+    const int score = entry->score;
+    if (entry->depth >= depth_left &&
+        (entry->bound == Bound::Exact ||
+         (entry->bound == Bound::Lower && score >= beta) ||
+         (entry->bound == Bound::Upper && score <= alpha))) {
+      proven &= entry->depth == PROVEN_DEPTH;
+      return score;
+    }
+  }
+
+  bool node_proven = true;
+  const auto original_alpha = alpha;
+  const auto opponent = details::OpponentOf(active_player);
+  auto best_value = -details::SCORE_INFINITY;
+  auto best_move = PackedMove::Skip();
+
+  auto &ordering = orderings_[scheduler_.CurrentWorkerIndex()];
+  StagedMoves<HEIGHT, WIDTH, RULES> possible_moves(
+      rules_, ordering, board, active_player, hash_move, ply);
+  if (not possible_moves.HasAny()) {
+    // The game is over if the opponent can not move either, in which case
+    // the static evaluation is the final score.
+    if (not rules_.HasLegalMoves(board, opponent)) {
+      best_value = Evaluate(board, active_player);
+    } else {
+      // a player without legal moves has to skip the turn
+      best_value = -Negamax(board, opponent, depth_left - 1, ply + 1, -beta,
+                            -alpha, split_point, node_proven);
+    }
+  } else {
+    std::size_t best_index = 0;
+    if (depth_left == 1 && tablebase_ == nullptr) {
+      SearchLeaves(board, active_player, possible_moves.All(), ply, alpha,
+                   beta, split_point, best_value, best_index);
+      node_proven = false;
+      best_move = possible_moves.All()[best_index];
+    } else {
+      // The eldest brother is always searched serially, and the others are
+      // only generated if it does not cause a cutoff.
+      const auto first_move = possible_moves.Next().value();
+      best_move = first_move;
+      board.Make(first_move);
+      best_value = -Negamax(board, opponent, depth_left - 1, ply + 1, -beta,
+                            -alpha, split_point, node_proven);
+      board.Undo();
+      alpha = std::max(alpha, best_value);
+      if (alpha >= beta) {
+        ordering.RecordCutoff(board, first_move, ply, depth_left);
+      }
+
+      const auto all_moves =
+          alpha < beta ? possible_moves.All() : std::span<const PackedMove>();
+      if (all_moves.size() > 1) {
+        if (depth_left >= MIN_SPLIT_DEPTH) {
+          SearchSiblings(board, active_player, all_moves, depth_left, ply,
+                         alpha, beta, split_point, best_value, best_index,
+                         node_proven);
+        } else {
+          for (std::size_t index = 1; index < all_moves.size(); ++index) {
+            const auto move = all_moves[index];
+            board.Make(move);
+            const auto value =
+                -Negamax(board, opponent, depth_left - 1, ply + 1, -beta,
+                         -alpha, split_point, node_proven);
+            board.Undo();
+            if (value > best_value) {
+              best_value = value;
+              best_index = index;
+            }
+            alpha = std::max(alpha, value);
+            if (alpha >= beta) {
+              ordering.RecordCutoff(board, move, ply, depth_left);
+              break;
+            }
+          }
+        }
+        best_move = all_moves[best_index];
+      }
+    }
+  }
+
+  if (IsAborted(split_point)) {
+    return 0;
+  }
+  const auto bound = best_value <= original_alpha ? Bound::Upper
+                     : best_value >= beta         ? Bound::Lower
+                                                  : Bound::Exact;
+  transposition_table_.Store(
+      key, {static_cast<int16_t>(best_value),
+            node_proven ? PROVEN_DEPTH : depth_left, bound,
+            Transform<HEIGHT, WIDTH>(UnpackMove<HEIGHT, WIDTH>(best_move),
+                                     symmetry)});
+  proven &= node_proven;
+  return best_value;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+void YbwcSearch<HEIGHT, WIDTH, RULES>::SearchSiblings(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    const std::span<const PackedMove> moves, const uint8_t depth_left,
+    const uint8_t ply, const int alpha, const int beta,
+    const SplitPoint *split_point, int &best_value, std::size_t &best_index,
+    bool &proven) noexcept {
+  SplitPoint node(split_point, alpha, beta, moves.size() - 1);
+  node.best_value = best_value;
+  node.best_index = best_index;
+  node.proven = proven;
+  const auto opponent = details::OpponentOf(active_player);
+
+  for (std::size_t index = 1; index < moves.size(); ++index) {
+    scheduler_.Spawn([this, &node, &board, moves, opponent, depth_left, ply,
+                      index] {
+      if (not IsAborted(&node)) {
+        // each task works on its own copy of the board
+        auto child_board = board;
+        child_board.Make(moves[index]);
+        const auto window_alpha = node.alpha.load(std::memory_order_relaxed);
+        bool child_proven = true;
+        const auto value =
+            -Negamax(child_board, opponent, depth_left - 1, ply + 1,
+                     -node.beta, -window_alpha, &node, child_proven);
+        if (not IsAborted(&node)) {
+          std::lock_guard<std::mutex> lock(node.mutex);
+          // Only values inside the window are exact, so a tie is only
+          // resolved in favour of the earlier move if both are exact.
+          const auto is_exact = value > window_alpha && value < node.beta;
+          if (value > node.best_value ||
+              (value == node.best_value && is_exact &&
+               index < node.best_index)) {
+            node.best_value = value;
+            node.best_index = index;
+          }
+          if (value > node.alpha.load(std::memory_order_relaxed)) {
+            node.alpha.store(value, std::memory_order_relaxed);
+          }
+          if (not child_proven) {
+            node.proven.store(false, std::memory_order_relaxed);
+          }
+          if (value >= node.beta) {
+            orderings_[scheduler_.CurrentWorkerIndex()].RecordCutoff(
+                board, moves[index], ply, depth_left);
+            // aborts all younger brothers that are still searched
+            node.cutoff.store(true, std::memory_order_relaxed);
+          }
+        }
+      }
+      node.num_pending_tasks.fetch_sub(1, std::memory_order_acq_rel);
+    });
+  }
+  scheduler_.HelpUntil([&node] {
+    return node.num_pending_tasks.load(std::memory_order_acquire) == 0;
+  });
+
+  std::lock_guard<std::mutex> lock(node.mutex);
+  best_value = node.best_value;
+  best_index = node.best_index;
+  proven = node.proven.load(std::memory_order_relaxed);
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+void YbwcSearch<HEIGHT, WIDTH, RULES>::SearchLeaves(
+    const Board<HEIGHT, WIDTH> &board, const Color active_player,
+    const std::span<const PackedMove> moves, const uint8_t ply, int &alpha,
+    const int beta, const SplitPoint *split_point, int &best_value,
+    std::size_t &best_index) noexcept {
+  const auto worker = scheduler_.CurrentWorkerIndex();
+  std::array<game_value_t, MoveList<HEIGHT, WIDTH>::CAPACITY> values;
+  rules_.ComputeValuesAfter(board, moves, values);
+  best_value = -details::SCORE_INFINITY;
+  for (std::size_t index = 0; index < moves.size(); ++index) {
+    CountNode(ply + 1);
+    if (IsAborted(split_point)) {
+      return;
+    }
+    const int value =
+        active_player == Color::Blue ? values[index] : -values[index];
+    if (value > best_value) {
+      best_value = value;
+      best_index = index;
+    }
+    alpha = std::max(alpha, value);
+    if (alpha >= beta) {
+      orderings_[worker].RecordCutoff(board, moves[index], ply, 1);
+      return;
+    }
+  }
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+void YbwcSearch<HEIGHT, WIDTH, RULES>::CountNode(const uint8_t ply) noexcept {
+  auto &statistics = statistics_[scheduler_.CurrentWorkerIndex()];
+  const auto num_explored_nodes =
+      statistics.num_explored_nodes.load(std::memory_order_relaxed) + 1;
+  statistics.num_explored_nodes.store(num_explored_nodes,
+                                      std::memory_order_relaxed);
+  if (ply > statistics.max_explored_depth.load(std::memory_order_relaxed)) {
+    statistics.max_explored_depth.store(ply, std::memory_order_relaxed);
+  }
+  if (num_explored_nodes % details::NODES_BETWEEN_CLOCK_CHECKS == 0 &&
+      deadline_.HasPassed()) {
+    stopped_.store(true, std::memory_order_relaxed);
+  }
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+uint64_t YbwcSearch<HEIGHT, WIDTH, RULES>::num_explored_nodes() const noexcept {
+  uint64_t num_explored_nodes = 0;
+  for (const auto &statistics : statistics_) {
+    num_explored_nodes +=
+        statistics.num_explored_nodes.load(std::memory_order_relaxed);
+  }
+  return num_explored_nodes;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH, Ruleset<HEIGHT, WIDTH> RULES>
+uint8_t YbwcSearch<HEIGHT, WIDTH, RULES>::max_explored_depth() const noexcept {
+  uint8_t max_explored_depth = 0;
+  for (const auto &statistics : statistics_) {
+    max_explored_depth = std::max(
+        max_explored_depth,
+        statistics.max_explored_depth.load(std::memory_order_relaxed));
+  }
+  return max_explored_depth;
+}
+}  // namespace libsanjego
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "libsanjego/mapped_file.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <utility>
+
+namespace libsanjego {
+#ifdef _WIN32
+std::optional<MappedFile> MappedFile::Open(const std::string &path) noexcept {
+  const auto file =
+      CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return {};
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    return {};
+  }
+  const auto mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  // the mapping keeps the file open on its own
+  CloseHandle(file);
+  if (mapping == nullptr) {
+    return {};
+  }
+  const auto *const data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  // the view keeps the mapping alive on its own
+  CloseHandle(mapping);
+  if (data == nullptr) {
+    return {};
+  }
+  return MappedFile(static_cast<const std::byte *>(data),
+                    static_cast<std::size_t>(size.QuadPart));
+}
+
+void MappedFile::Unmap() noexcept {
+  if (data_ != nullptr) {
+    UnmapViewOfFile(data_);
+  }
+}
+#else
+std::optional<MappedFile> MappedFile::Open(const std::string &path) noexcept {
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    return {};
+  }
+  struct stat status {};
+  if (fstat(file, &status) != 0 || status.st_size <= 0) {
+    close(file);
+    return {};
+  }
+  const auto size = static_cast<std::size_t>(status.st_size);
+  void *const data = mmap(nullptr, size, PROT_READ, MAP_SHARED, file, 0);
+  // the mapping keeps the file open on its own
+  close(file);
+  if (data == MAP_FAILED) {
+    return {};
+  }
+  return MappedFile(static_cast<const std::byte *>(data), size);
+}
+
+void MappedFile::Unmap() noexcept {
+  if (data_ != nullptr) {
+    munmap(const_cast<std::byte *>(data_), size_);
+  }
+}
+#endif
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    Unmap();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() { Unmap(); }
+}  // namespace libsanjego
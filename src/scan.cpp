@@ -0,0 +1,175 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "libsanjego/scan.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SANJEGO_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace libsanjego {
+// The kernels read the packed representation of towers directly.
+static_assert(sizeof(Tower) == sizeof(tower_size_t));
+static_assert(std::is_trivially_copyable_v<Tower>);
+
+namespace {
+OwnerScan ScanScalar(const std::span<const Tower> towers,
+                     const Color owner) noexcept {
+  OwnerScan scan{0, 0};
+  for (const auto &tower : towers) {
+    if (tower.height() > 0 && tower.top() == owner) {
+      scan.max_height = std::max(scan.max_height, tower.height());
+      ++scan.num_towers;
+    }
+  }
+  return scan;
+}
+
+#ifdef SANJEGO_X86_KERNELS
+/*
+ * Each lane holds a tower as [height: bit 15..1 | owner: bit 0]. A lane is
+ * selected if it is not empty and its owner bit matches; the selected
+ * heights are folded into a running maximum, and as selected lanes are all
+ * ones, subtracting them counts the towers lane by lane.
+ */
+__attribute__((target("sse4.1"))) OwnerScan ScanSse41(
+    const std::span<const Tower> towers, const Color owner) noexcept {
+  constexpr std::size_t LANES = 8;
+  const auto *const data = towers.data();
+  const auto zero = _mm_setzero_si128();
+  const auto owner_bits = _mm_set1_epi16(static_cast<int16_t>(owner));
+  const auto one = _mm_set1_epi16(1);
+  auto max_heights = zero;
+  auto counts = zero;
+  std::size_t index = 0;
+  for (; index + LANES <= towers.size(); index += LANES) {
+    const auto lanes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + index));
+    const auto selected = _mm_andnot_si128(
+        _mm_cmpeq_epi16(lanes, zero),
+        _mm_cmpeq_epi16(_mm_and_si128(lanes, one), owner_bits));
+    max_heights = _mm_max_epu16(
+        max_heights, _mm_and_si128(_mm_srli_epi16(lanes, 1), selected));
+    counts = _mm_sub_epi16(counts, selected);
+  }
+  // the minimum of the complements is the complement of the maximum
+  const auto all_ones = _mm_cmpeq_epi16(zero, zero);
+  const auto min_position =
+      _mm_minpos_epu16(_mm_xor_si128(max_heights, all_ones));
+  OwnerScan scan{static_cast<tower_size_t>(
+                     ~static_cast<uint16_t>(_mm_extract_epi16(min_position, 0))),
+                 0};
+  // pairs of 16 bit counts are summed to 32 bits before they can overflow
+  const auto wide_counts = _mm_madd_epi16(counts, one);
+  alignas(16) uint32_t sums[4];
+  _mm_store_si128(reinterpret_cast<__m128i *>(sums), wide_counts);
+  scan.num_towers = sums[0] + sums[1] + sums[2] + sums[3];
+
+  const auto rest = ScanScalar(towers.subspan(index), owner);
+  scan.max_height = std::max(scan.max_height, rest.max_height);
+  scan.num_towers += rest.num_towers;
+  return scan;
+}
+
+__attribute__((target("avx2"))) OwnerScan ScanAvx2(
+    const std::span<const Tower> towers, const Color owner) noexcept {
+  constexpr std::size_t LANES = 16;
+  const auto *const data = towers.data();
+  const auto zero = _mm256_setzero_si256();
+  const auto owner_bits = _mm256_set1_epi16(static_cast<int16_t>(owner));
+  const auto one = _mm256_set1_epi16(1);
+  auto max_heights = zero;
+  auto counts = zero;
+  std::size_t index = 0;
+  for (; index + LANES <= towers.size(); index += LANES) {
+    const auto lanes =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + index));
+    const auto selected = _mm256_andnot_si256(
+        _mm256_cmpeq_epi16(lanes, zero),
+        _mm256_cmpeq_epi16(_mm256_and_si256(lanes, one), owner_bits));
+    max_heights = _mm256_max_epu16(
+        max_heights, _mm256_and_si256(_mm256_srli_epi16(lanes, 1), selected));
+    counts = _mm256_sub_epi16(counts, selected);
+  }
+  const auto halved_max = _mm_max_epu16(_mm256_castsi256_si128(max_heights),
+                                        _mm256_extracti128_si256(max_heights, 1));
+  const auto all_ones = _mm_cmpeq_epi16(halved_max, halved_max);
+  const auto min_position =
+      _mm_minpos_epu16(_mm_xor_si128(halved_max, all_ones));
+  OwnerScan scan{static_cast<tower_size_t>(
+                     ~static_cast<uint16_t>(_mm_extract_epi16(min_position, 0))),
+                 0};
+  const auto wide_counts = _mm256_madd_epi16(counts, one);
+  alignas(32) uint32_t sums[8];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(sums), wide_counts);
+  for (const auto sum : sums) {
+    scan.num_towers += sum;
+  }
+
+  const auto rest = ScanScalar(towers.subspan(index), owner);
+  scan.max_height = std::max(scan.max_height, rest.max_height);
+  scan.num_towers += rest.num_towers;
+  return scan;
+}
+#endif
+
+details::SimdLevel DetectSimdLevel() noexcept {
+#ifdef SANJEGO_X86_KERNELS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return details::SimdLevel::Avx2;
+  }
+  if (__builtin_cpu_supports("sse4.1")) {
+    return details::SimdLevel::Sse41;
+  }
+#endif
+  return details::SimdLevel::Scalar;
+}
+}  // namespace
+
+OwnerScan ScanTowersOf(const std::span<const Tower> towers,
+                       const Color owner) noexcept {
+  return details::ScanTowersWith(details::DetectedSimdLevel(), towers, owner);
+}
+
+namespace details {
+SimdLevel DetectedSimdLevel() noexcept {
+  static const auto level = DetectSimdLevel();
+  return level;
+}
+
+OwnerScan ScanTowersWith(const SimdLevel level,
+                         const std::span<const Tower> towers,
+                         const Color owner) noexcept {
+  switch (level) {
+#ifdef SANJEGO_X86_KERNELS
+    case SimdLevel::Avx2:
+      return ScanAvx2(towers, owner);
+    case SimdLevel::Sse41:
+      return ScanSse41(towers, owner);
+#endif
+    default:
+      return ScanScalar(towers, owner);
+  }
+}
+}  // namespace details
+}  // namespace libsanjego
@@ -0,0 +1,132 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "libsanjego/scheduler.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+namespace libsanjego {
+
+// identifies the scheduler and worker slot of threads owned by a scheduler
+thread_local const WorkStealingScheduler *current_scheduler = nullptr;
+thread_local unsigned int current_worker_index = 0;
+
+// Idle workers wake up this often even if they missed a notification.
+constexpr auto MAX_SLEEP_DURATION = std::chrono::milliseconds(1);
+
+WorkStealingScheduler::WorkStealingScheduler(const unsigned int num_workers) {
+  const auto num_all_workers = std::max(num_workers, 1U);
+  for (unsigned int index = 0; index < num_all_workers; ++index) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  for (unsigned int index = 1; index < num_all_workers; ++index) {
+    threads_.emplace_back([this, index] { Run(index); });
+  }
+}
+
+WorkStealingScheduler::~WorkStealingScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    shutting_down_ = true;
+  }
+  wake_up_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkStealingScheduler::Spawn(Task task) {
+  auto &worker = *workers_[CurrentWorkerIndex()];
+  {
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    worker.tasks.push_back(std::move(task));
+  }
+  num_queued_tasks_.fetch_add(1, std::memory_order_release);
+  wake_up_.notify_one();
+}
+
+void WorkStealingScheduler::HelpUntil(const std::function<bool()> &done) {
+  const auto index = CurrentWorkerIndex();
+  while (not done()) {
+    auto task = TryPop(index);
+    if (not task.has_value()) {
+      task = TrySteal(index);
+    }
+    if (task.has_value()) {
+      (*task)();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+unsigned int WorkStealingScheduler::CurrentWorkerIndex() const noexcept {
+  return current_scheduler == this ? current_worker_index : 0;
+}
+
+std::optional<WorkStealingScheduler::Task> WorkStealingScheduler::TryPop(
+    const unsigned int worker_index) {
+  auto &worker = *workers_[worker_index];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return {};
+  }
+  auto task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  num_queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+  return task;
+}
+
+std::optional<WorkStealingScheduler::Task> WorkStealingScheduler::TrySteal(
+    const unsigned int thief_index) {
+  for (std::size_t offset = 1; offset < workers_.size(); ++offset) {
+    auto &victim = *workers_[(thief_index + offset) % workers_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (victim.tasks.empty()) {
+      continue;
+    }
+    auto task = std::move(victim.tasks.front());
+    victim.tasks.pop_front();
+    num_queued_tasks_.fetch_sub(1, std::memory_order_relaxed);
+    return task;
+  }
+  return {};
+}
+
+void WorkStealingScheduler::Run(const unsigned int worker_index) {
+  current_scheduler = this;
+  current_worker_index = worker_index;
+  while (not shutting_down_.load(std::memory_order_acquire)) {
+    auto task = TryPop(worker_index);
+    if (not task.has_value()) {
+      task = TrySteal(worker_index);
+    }
+    if (task.has_value()) {
+      (*task)();
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_up_.wait_for(lock, MAX_SLEEP_DURATION, [this] {
+      return shutting_down_.load(std::memory_order_acquire) ||
+             num_queued_tasks_.load(std::memory_order_acquire) > 0;
+    });
+  }
+}
+}  // namespace libsanjego
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "libsanjego/session.hpp"
+
+#include <array>
+#include <utility>
+
+namespace libsanjego {
+namespace {
+typedef std::unique_ptr<Session> (*SessionFactory)(Engine,
+                                                   std::size_t) noexcept;
+typedef std::array<SessionFactory, MAX_SESSION_WIDTH> FactoryRow;
+
+template <board_size_t HEIGHT, board_size_t... WIDTHS>
+constexpr FactoryRow FactoryRowOf(
+    std::integer_sequence<board_size_t, WIDTHS...>) noexcept {
+  return {&details::CreateSessionOf<HEIGHT, WIDTHS + 1>...};
+}
+
+template <board_size_t... HEIGHTS>
+constexpr std::array<FactoryRow, MAX_SESSION_HEIGHT> FactoryTableOf(
+    std::integer_sequence<board_size_t, HEIGHTS...>) noexcept {
+  return {FactoryRowOf<HEIGHTS + 1>(
+      std::make_integer_sequence<board_size_t, MAX_SESSION_WIDTH>())...};
+}
+
+// indexed by height - 1 and width - 1
+constexpr auto SESSION_FACTORIES = FactoryTableOf(
+    std::make_integer_sequence<board_size_t, MAX_SESSION_HEIGHT>());
+}  // namespace
+
+std::unique_ptr<Session> CreateSession(
+    const board_size_t height, const board_size_t width, const Engine engine,
+    const std::size_t memory_in_mb) noexcept {
+  if (height == 0 || height > MAX_SESSION_HEIGHT || width == 0 ||
+      width > MAX_SESSION_WIDTH) {
+    return nullptr;
+  }
+  return SESSION_FACTORIES[height - 1][width - 1](engine, memory_in_mb);
+}
+}  // namespace libsanjego
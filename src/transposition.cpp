@@ -0,0 +1,141 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include "libsanjego/transposition.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace libsanjego {
+
+/*
+ * Layout of a slot's data word:
+ * [move: bit 63..32 | generation: bit 31..26 | bound: bit 25..24 |
+ *  depth: bit 23..16 | score: bit 15..0]
+ * where the move consists of the source row and column followed by the
+ * target row and column, one byte each.
+ */
+constexpr uint8_t DEPTH_SHIFT = 16;
+constexpr uint8_t BOUND_SHIFT = 24;
+constexpr uint8_t GENERATION_SHIFT = 26;
+constexpr uint8_t MOVE_SHIFT = 32;
+constexpr uint8_t GENERATION_MASK = 0x3F;
+
+constexpr uint64_t Pack(const TranspositionEntry &entry,
+                        const uint8_t generation) {
+  const auto &move = entry.best_move;
+  const uint64_t packed_move = uint64_t{move.source.row} |
+                               uint64_t{move.source.column} << 8 |
+                               uint64_t{move.target.row} << 16 |
+                               uint64_t{move.target.column} << 24;
+  return static_cast<uint16_t>(entry.score) |
+         uint64_t{entry.depth} << DEPTH_SHIFT |
+         uint64_t{static_cast<uint8_t>(entry.bound)} << BOUND_SHIFT |
+         uint64_t{generation} << GENERATION_SHIFT |
+         packed_move << MOVE_SHIFT;
+}
+
+constexpr TranspositionEntry Unpack(const uint64_t data) {
+  const auto ByteAt = [data](const uint8_t shift) {
+    return static_cast<board_size_t>(data >> shift);
+  };
+  return TranspositionEntry{
+      .score = static_cast<int16_t>(data),
+      .depth = static_cast<uint8_t>(data >> DEPTH_SHIFT),
+      .bound = static_cast<Bound>((data >> BOUND_SHIFT) & 0x3),
+      .best_move = Move{{ByteAt(MOVE_SHIFT), ByteAt(MOVE_SHIFT + 8)},
+                        {ByteAt(MOVE_SHIFT + 16), ByteAt(MOVE_SHIFT + 24)}},
+  };
+}
+
+constexpr uint8_t GenerationOf(const uint64_t data) {
+  return (data >> GENERATION_SHIFT) & GENERATION_MASK;
+}
+
+constexpr std::size_t SLOTS_PER_MB = (1 << 20) / (2 * sizeof(uint64_t));
+
+TranspositionTable::TranspositionTable(const std::size_t size_in_mb)
+    : slots_(), mask_(0), counters_() {
+  const auto num_slots =
+      std::bit_floor(std::max<std::size_t>(size_in_mb * SLOTS_PER_MB, 1));
+  slots_ = std::make_unique<Slot[]>(num_slots);
+  mask_ = num_slots - 1;
+}
+
+std::optional<TranspositionEntry> TranspositionTable::Probe(
+    const uint64_t key) noexcept {
+  auto &slot = slots_[key & mask_];
+  const auto data = slot.data.load(std::memory_order_relaxed);
+  const auto checksum = slot.checksum.load(std::memory_order_relaxed);
+  auto &counters = CountersFor(key);
+  if ((checksum ^ data) != key || data == 0) {
+    counters.misses.fetch_add(1, std::memory_order_relaxed);
+    return {};
+  }
+  counters.hits.fetch_add(1, std::memory_order_relaxed);
+  return Unpack(data);
+}
+
+void TranspositionTable::Store(const uint64_t key,
+                               const TranspositionEntry &entry) noexcept {
+  auto &slot = slots_[key & mask_];
+  const auto generation = generation_.load(std::memory_order_relaxed);
+  const auto old_data = slot.data.load(std::memory_order_relaxed);
+  const auto old_key = slot.checksum.load(std::memory_order_relaxed) ^ old_data;
+  if (old_data != 0 && old_key != key) {
+    CountersFor(key).collisions.fetch_add(1, std::memory_order_relaxed);
+    const auto old_entry = Unpack(old_data);
+    if (GenerationOf(old_data) == generation &&
+        old_entry.depth > entry.depth) {
+      return;
+    }
+  }
+  const auto data = Pack(entry, generation);
+  slot.checksum.store(key ^ data, std::memory_order_relaxed);
+  slot.data.store(data, std::memory_order_relaxed);
+}
+
+void TranspositionTable::NewSearch() noexcept {
+  const auto generation = generation_.load(std::memory_order_relaxed);
+  generation_.store((generation + 1) & GENERATION_MASK,
+                    std::memory_order_relaxed);
+}
+
+void TranspositionTable::Clear() noexcept {
+  for (std::size_t index = 0; index <= mask_; ++index) {
+    slots_[index].checksum.store(0, std::memory_order_relaxed);
+    slots_[index].data.store(0, std::memory_order_relaxed);
+  }
+  for (auto &counters : counters_) {
+    counters.hits.store(0, std::memory_order_relaxed);
+    counters.misses.store(0, std::memory_order_relaxed);
+    counters.collisions.store(0, std::memory_order_relaxed);
+  }
+}
+
+TranspositionStatistics TranspositionTable::statistics() const noexcept {
+  TranspositionStatistics statistics{0, 0, 0};
+  for (const auto &counters : counters_) {
+    statistics.hits += counters.hits.load(std::memory_order_relaxed);
+    statistics.misses += counters.misses.load(std::memory_order_relaxed);
+    statistics.collisions +=
+        counters.collisions.load(std::memory_order_relaxed);
+  }
+  return statistics;
+}
+}  // namespace libsanjego
@@ -0,0 +1,120 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "libsanjego/async.hpp"
+#include "libsanjego/bot.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/mcts.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/search.hpp"
+
+// To make the test cases more readable
+using namespace libsanjego;
+
+TEST_CASE("Iterations should be reported to the progress callback",
+          "[fast]") {
+  const Board<4, 4> board;
+  FullExplorer<4, 4> explorer;
+  std::vector<SearchProgress> reports;
+  explorer.ReportProgressTo(
+      [&reports](const SearchProgress &progress) {
+        reports.push_back(progress);
+      });
+  const auto result = explorer.Explore(board, Color::Blue,
+                                       std::chrono::milliseconds(20));
+  REQUIRE_FALSE(reports.empty());
+  for (std::size_t index = 0; index < reports.size(); ++index) {
+    REQUIRE(reports[index].depth == index + 1);
+    REQUIRE(reports[index].score.has_value());
+    REQUIRE(reports[index].num_explored_nodes > 0);
+    REQUIRE_FALSE(reports[index].principal_variation.empty());
+  }
+  REQUIRE(reports.back().principal_variation.front() == result.best_move);
+}
+
+TEST_CASE("An asynchronous search should deliver the result", "[fast]") {
+  const Board<2, 3> board;
+  SolvingExplorer<2, 3> explorer;
+  AsyncSearch<2, 3> search(explorer, board, Color::Blue);
+  const auto result = search.Wait();
+  REQUIRE(search.IsDone());
+  REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+  REQUIRE(result.proven_value == 2);
+  REQUIRE(search.progress()->score == 2);
+  REQUIRE(search.CurrentBestMove() == result.best_move);
+}
+
+TEST_CASE("An asynchronous search should stop when asked to", "[fast]") {
+  const Board<9, 9> board;
+  FullExplorer<9, 9> explorer;
+  std::vector<uint8_t> depths;
+  explorer.ReportProgressTo([&depths](const SearchProgress &progress) {
+    depths.push_back(progress.depth);
+  });
+  AsyncSearch<9, 9> search(explorer, board, Color::Blue);
+  while (not search.CurrentBestMove().has_value()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  const auto current_best_move = search.CurrentBestMove().value();
+  StandardRuleset<9, 9> rules;
+  const auto legal_moves = rules.GetLegalMoves(board, Color::Blue);
+  REQUIRE(std::find(legal_moves.begin(), legal_moves.end(),
+                    current_best_move) != legal_moves.end());
+
+  const auto stop_time = std::chrono::steady_clock::now();
+  search.Stop();
+  const auto result = search.Wait();
+  const std::chrono::duration<double> delay =
+      std::chrono::steady_clock::now() - stop_time;
+  REQUIRE(delay.count() < 0.5);
+  REQUIRE_FALSE(result.best_move.IsSkip());
+  // reports are still passed on to the explorer's callback
+  REQUIRE_FALSE(depths.empty());
+}
+
+TEST_CASE("An asynchronous search should follow its stop token", "[fast]") {
+  const Board<9, 9> board;
+  MctsExplorer<9, 9> explorer;
+  std::stop_source stop_source;
+  AsyncSearch<9, 9> search(explorer, board, Color::Blue,
+                           std::chrono::steady_clock::time_point::max(),
+                           stop_source.get_token());
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  stop_source.request_stop();
+  const auto result = search.Wait();
+  REQUIRE(result.num_explored_nodes > 0);
+  REQUIRE_FALSE(result.best_move.IsSkip());
+}
+
+TEST_CASE("An asynchronous search should follow a moved deadline",
+          "[fast]") {
+  const Board<9, 9> board;
+  FullExplorer<9, 9> explorer;
+  AsyncSearch<9, 9> search(explorer, board, Color::Blue);
+  search.MoveDeadlineTo(std::chrono::steady_clock::now() +
+                        std::chrono::milliseconds(20));
+  const auto result = search.Wait();
+  REQUIRE(result.seconds_spent < 0.5);
+}
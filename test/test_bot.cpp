@@ -16,11 +16,17 @@
  * You should have received a copy of the GNU General Public License
  * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
+#include <memory>
 
 #include "catch2/catch.hpp"
 #include "libsanjego/bot.hpp"
+#include "libsanjego/mcts.hpp"
 #include "libsanjego/gameobjects.hpp"
+#include "libsanjego/rulesets.hpp"
 
 // To make the test cases more readable
 using namespace libsanjego;
@@ -72,4 +78,367 @@ TEST_CASE("Time spent should be non-negative", "[fast]") {
   const auto active_player = Color::Blue;
   const auto time_spent = explorer.Explore(board, active_player).seconds_spent;
   REQUIRE(time_spent >= 0);
-}
\ No newline at end of file
+}
+TEST_CASE("Reported depth should equal the configured search depth",
+          "[fast]") {
+  const Board<3, 3> board;
+  FullExplorer<3, 3> explorer(3);
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE(result.max_explored_depth == 3);
+}
+
+TEST_CASE("Reported depth should be limited by the end of the game",
+          "[fast]") {
+  // after the only move, no player can move anymore
+  const Board<1, 2> board;
+  FullExplorer<1, 2> explorer(5);
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE(result.max_explored_depth == 1);
+  // the root and its only child
+  REQUIRE(result.num_explored_nodes == 2);
+}
+
+TEST_CASE("Deeper searches should explore more nodes", "[fast]") {
+  const Board<3, 3> board;
+  FullExplorer<3, 3> shallow_explorer(1);
+  FullExplorer<3, 3> deep_explorer(3);
+  const auto shallow_result = shallow_explorer.Explore(board, Color::Blue);
+  const auto deep_result = deep_explorer.Explore(board, Color::Blue);
+  REQUIRE(deep_result.num_explored_nodes > shallow_result.num_explored_nodes);
+}
+
+TEST_CASE("A timed search should not exceed its budget by much", "[fast]") {
+  const Board<6, 6> board;
+  FullExplorer<6, 6> explorer;
+  const auto budget = std::chrono::milliseconds(50);
+  const auto result = explorer.Explore(board, Color::Blue, budget);
+  REQUIRE(result.seconds_spent < 0.1);
+  REQUIRE_FALSE(result.best_move.IsSkip());
+}
+
+TEST_CASE("A timed search should stop once the game tree is exhausted",
+          "[fast]") {
+  const Board<2, 2> board;
+  FullExplorer<2, 2> explorer;
+  const auto result =
+      explorer.Explore(board, Color::Blue, std::chrono::seconds(10));
+  REQUIRE(result.seconds_spent < 1);
+  // on a 2x2 board, there are at most 3 moves left, each with a possible skip
+  REQUIRE(result.max_explored_depth <= 6);
+}
+
+TEST_CASE("A timed search should deepen iteratively", "[fast]") {
+  const Board<3, 3> board;
+  FullExplorer<3, 3> explorer;
+  const auto result =
+      explorer.Explore(board, Color::Blue, std::chrono::milliseconds(20));
+  REQUIRE(result.max_explored_depth > 1);
+}
+
+TEST_CASE("A timed search should return skip when there is no legal move",
+          "[fast]") {
+  const Board<1, 1> board;
+  FullExplorer<1, 1> explorer;
+  const auto result =
+      explorer.Explore(board, Color::Blue, std::chrono::milliseconds(10));
+  REQUIRE(result.best_move.IsSkip());
+}
+
+TEST_CASE("Transpositions should be found in the table", "[fast]") {
+  const Board<3, 3> board;
+  FullExplorer<3, 3> explorer(4);
+  explorer.Explore(board, Color::Blue);
+  REQUIRE(explorer.transposition_table().statistics().hits > 0);
+}
+
+TEST_CASE("Explorers can share a transposition table", "[fast]") {
+  const Board<3, 3> board;
+  const auto table = std::make_shared<TranspositionTable>(1);
+  FullExplorer<3, 3> explorer(4, table);
+  FullExplorer<3, 3> other_explorer(4, table);
+
+  const auto result = explorer.Explore(board, Color::Blue);
+  const auto other_result = other_explorer.Explore(board, Color::Blue);
+
+  REQUIRE(other_result.num_explored_nodes < result.num_explored_nodes);
+  REQUIRE(other_result.best_move == result.best_move);
+}
+
+TEST_CASE("A parallel search should return a legal move", "[fast]") {
+  const Board<4, 4> board;
+  const auto ruleset = CreateStandardRulesetFor(board);
+  LazySmpExplorer<4, 4> explorer(4);
+  const auto result = explorer.Explore(board, Color::Blue);
+  const auto legal_moves = ruleset->GetLegalMoves(board, Color::Blue);
+  REQUIRE(std::find(legal_moves.begin(), legal_moves.end(),
+                    result.best_move) != legal_moves.end());
+}
+
+TEST_CASE("A parallel search should find the only optimal move", "[fast]") {
+  // Searching to the end of the game reveals that only this move leads to a
+  // final value of 2 while the others lead to 0 or less.
+  const Board<2, 3> board;
+  LazySmpExplorer<2, 3> explorer(3, 10);
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+}
+
+TEST_CASE("A timed parallel search should not exceed its budget by much",
+          "[fast]") {
+  const Board<5, 5> board;
+  LazySmpExplorer<5, 5> explorer(4);
+  const auto budget = std::chrono::milliseconds(50);
+  const auto result = explorer.Explore(board, Color::Blue, budget);
+  REQUIRE(result.seconds_spent < 0.1);
+  REQUIRE(result.max_explored_depth > 1);
+  REQUIRE_FALSE(result.best_move.IsSkip());
+}
+
+TEST_CASE("A work-stealing search should find the only optimal move",
+          "[fast]") {
+  const Board<2, 3> board;
+  YbwcExplorer<2, 3> explorer(3, 10);
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+}
+
+TEST_CASE("A work-stealing search should reach the configured depth",
+          "[fast]") {
+  const Board<4, 4> board;
+  YbwcExplorer<4, 4> explorer(4, 4);
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE(result.max_explored_depth == 4);
+  REQUIRE_FALSE(result.best_move.IsSkip());
+}
+
+TEST_CASE("A timed work-stealing search should not exceed its budget by much",
+          "[fast]") {
+  const Board<5, 5> board;
+  YbwcExplorer<5, 5> explorer(4);
+  const auto budget = std::chrono::milliseconds(50);
+  const auto result = explorer.Explore(board, Color::Blue, budget);
+  REQUIRE(result.seconds_spent < 0.1);
+  REQUIRE_FALSE(result.best_move.IsSkip());
+}
+
+TEST_CASE("A work-stealing search should return skip without legal moves",
+          "[fast]") {
+  const Board<1, 1> board;
+  YbwcExplorer<1, 1> explorer(2);
+  REQUIRE(explorer.Explore(board, Color::Blue).best_move.IsSkip());
+}
+
+TEST_CASE("A solver should prove the final value of the game", "[fast]") {
+  SECTION("As first player") {
+    const Board<2, 3> board;
+    SolvingExplorer<2, 3> explorer;
+    const auto result = explorer.Explore(board, Color::Blue);
+    REQUIRE(result.proven_value == 2);
+    REQUIRE(result.winner == Color::Blue);
+    REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+  }
+  SECTION("As second player") {
+    const Board<2, 3> board;
+    SolvingExplorer<2, 3> explorer;
+    const auto result = explorer.Explore(board, Color::Yellow);
+    REQUIRE(result.proven_value == -2);
+    REQUIRE(result.winner == Color::Yellow);
+  }
+  SECTION("Without legal moves") {
+    const Board<1, 1> board;
+    SolvingExplorer<1, 1> explorer;
+    const auto result = explorer.Explore(board, Color::Yellow);
+    REQUIRE(result.best_move.IsSkip());
+    REQUIRE(result.proven_value == 1);
+    REQUIRE(result.winner == Color::Blue);
+  }
+}
+
+TEST_CASE("A solver should agree with a complete search", "[fast]") {
+  const Board<1, 5> board;
+  SolvingExplorer<1, 5> solver;
+  FullExplorer<1, 5> explorer(10);
+  const auto solved = solver.Explore(board, Color::Blue);
+  const auto searched = explorer.Explore(board, Color::Blue);
+  REQUIRE(solved.proven_value == 1);
+  REQUIRE(searched.proven_value == 1);
+  REQUIRE(solved.winner == Color::Blue);
+}
+
+TEST_CASE("A timed solver should not report a winner it did not prove",
+          "[fast]") {
+  const Board<8, 8> board;
+  SolvingExplorer<8, 8> explorer;
+  const auto budget = std::chrono::milliseconds(20);
+  const auto result = explorer.Explore(board, Color::Blue, budget);
+  REQUIRE(result.seconds_spent < 0.1);
+  REQUIRE_FALSE(result.proven_value.has_value());
+  REQUIRE_FALSE(result.winner.has_value());
+  REQUIRE_FALSE(result.best_move.IsSkip());
+}
+
+TEST_CASE("The principal variation should be a legal line of play",
+          "[fast]") {
+  Board<2, 3> board;
+  SolvingExplorer<2, 3> explorer;
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE(result.principal_variation.size() >= 2);
+  REQUIRE(result.principal_variation.front() == result.best_move);
+  StandardRuleset<2, 3> rules;
+  auto player = Color::Blue;
+  for (auto move : result.principal_variation) {
+    const auto legal_moves = rules.GetLegalMoves(board, player);
+    if (move.IsSkip()) {
+      REQUIRE(legal_moves.empty());
+    } else {
+      REQUIRE(std::find(legal_moves.begin(), legal_moves.end(), move) !=
+              legal_moves.end());
+      board.Make(move);
+    }
+    player = player == Color::Blue ? Color::Yellow : Color::Blue;
+  }
+}
+
+TEST_CASE("A depth-limited search should not report a winner", "[fast]") {
+  const Board<4, 4> board;
+  FullExplorer<4, 4> explorer(2);
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE_FALSE(result.proven_value.has_value());
+  REQUIRE_FALSE(result.winner.has_value());
+}
+
+TEST_CASE("A Monte-Carlo search should return a legal move", "[fast]") {
+  const Board<5, 5> board;
+  MctsExplorer<5, 5> explorer(200, 1);
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE(result.num_explored_nodes == 200);
+  REQUIRE(result.max_explored_depth >= 1);
+  const auto ruleset = CreateStandardRulesetFor(board);
+  const auto legal_moves = ruleset->GetLegalMoves(board, Color::Blue);
+  REQUIRE(std::find(legal_moves.begin(), legal_moves.end(),
+                    result.best_move) != legal_moves.end());
+}
+
+TEST_CASE("A Monte-Carlo search should find the only winning move",
+          "[fast]") {
+  const Board<2, 3> board;
+  MctsExplorer<2, 3> explorer(5000, 1);
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+}
+
+TEST_CASE("A timed Monte-Carlo search should not exceed its budget by much",
+          "[fast]") {
+  const Board<9, 9> board;
+  MctsExplorer<9, 9> explorer;
+  const auto budget = std::chrono::milliseconds(50);
+  const auto result = explorer.Explore(board, Color::Blue, budget);
+  REQUIRE(result.seconds_spent < 0.1);
+  REQUIRE(result.num_explored_nodes > 0);
+  REQUIRE_FALSE(result.best_move.IsSkip());
+}
+
+TEST_CASE("A Monte-Carlo search should keep working when its tree is full",
+          "[fast]") {
+  // a tree of 0 MB still holds the root
+  const Board<3, 3> board;
+  MctsExplorer<3, 3> explorer(100, 0);
+  const auto result = explorer.Explore(board, Color::Blue);
+  REQUIRE(result.num_explored_nodes == 100);
+  REQUIRE_FALSE(result.best_move.IsSkip());
+}
+
+TEST_CASE("A Monte-Carlo search should keep the subtree of the next position",
+          "[fast]") {
+  Board<3, 3> board;
+  StandardRuleset<3, 3> rules;
+  MctsSearch<3, 3> search(1);
+  search.Reset(board, Color::Blue);
+  const Deadline deadline;
+  std::atomic<uint64_t> num_started_playouts = 0;
+  search.RunPlayouts(rules, 1, deadline, 2000, num_started_playouts);
+
+  const auto best_move = details::MostVisitedMove(search.RootVisits(), rules,
+                                                  board, Color::Blue);
+  auto variation = search.PrincipalVariation(best_move);
+  REQUIRE(variation.size() >= 2);
+  board.Make(variation[0]);
+  board.Make(variation[1]);
+  REQUIRE(search.MoveRootTo(board, Color::Blue));
+  REQUIRE_FALSE(search.RootVisits().empty());
+
+  // not in the tree with this player to move
+  REQUIRE_FALSE(search.MoveRootTo(board, Color::Yellow));
+  REQUIRE(search.RootVisits().empty());
+}
+
+TEST_CASE("A Monte-Carlo search should return skip without legal moves",
+          "[fast]") {
+  const Board<1, 1> board;
+  MctsExplorer<1, 1> explorer(10);
+  REQUIRE(explorer.Explore(board, Color::Blue).best_move.IsSkip());
+}
+
+TEST_CASE("A parallel Monte-Carlo search should find the only winning move",
+          "[fast]") {
+  const Board<2, 3> board;
+  SECTION("in a shared tree") {
+    ParallelMctsExplorer<2, 3> explorer(MctsParallelism::Tree, 3, 5000, 1);
+    const auto result = explorer.Explore(board, Color::Blue);
+    REQUIRE(result.num_explored_nodes == 5000);
+    REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+  }
+  SECTION("in separate trees") {
+    ParallelMctsExplorer<2, 3> explorer(MctsParallelism::Root, 3, 6000, 3);
+    const auto result = explorer.Explore(board, Color::Blue);
+    REQUIRE(result.num_explored_nodes == 6000);
+    REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+  }
+}
+
+TEST_CASE("A timed parallel Monte-Carlo search should not exceed its budget",
+          "[fast]") {
+  const Board<9, 9> board;
+  const auto parallelism =
+      GENERATE(MctsParallelism::Tree, MctsParallelism::Root);
+  ParallelMctsExplorer<9, 9> explorer(parallelism, 4);
+  const auto budget = std::chrono::milliseconds(50);
+  const auto result = explorer.Explore(board, Color::Blue, budget);
+  REQUIRE(result.seconds_spent < 0.1);
+  REQUIRE(result.num_explored_nodes >= 4);
+  REQUIRE_FALSE(result.best_move.IsSkip());
+}
+
+namespace {
+/*
+ * The standard ruleset, but counting how often moves are generated.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+struct CountingRuleset : StandardRuleset<HEIGHT, WIDTH> {
+  static inline std::atomic<uint64_t> num_generations = 0;
+
+  void GenerateLegalMoves(const Board<HEIGHT, WIDTH> &board,
+                          const Color active_player,
+                          MoveList<HEIGHT, WIDTH> &moves) const noexcept {
+    num_generations.fetch_add(1, std::memory_order_relaxed);
+    StandardRuleset<HEIGHT, WIDTH>::GenerateLegalMoves(board, active_player,
+                                                       moves);
+  }
+};
+}  // namespace
+
+TEST_CASE("Explorers should search with the ruleset they are given",
+          "[fast]") {
+  STATIC_REQUIRE(Ruleset<StandardRuleset<3, 3>, 3, 3>);
+  STATIC_REQUIRE(Ruleset<CountingRuleset<3, 3>, 3, 3>);
+  STATIC_REQUIRE_FALSE(Ruleset<StandardRuleset<3, 4>, 3, 3>);
+
+  const Board<3, 3> board;
+  FullExplorer<3, 3> standard_explorer(4);
+  FullExplorer<3, 3, CountingRuleset<3, 3>> counting_explorer(4);
+  const auto expected = standard_explorer.Explore(board, Color::Blue);
+  const auto result = counting_explorer.Explore(board, Color::Blue);
+  REQUIRE(result.best_move == expected.best_move);
+  REQUIRE(result.num_explored_nodes == expected.num_explored_nodes);
+  REQUIRE(CountingRuleset<3, 3>::num_generations > 0);
+}
@@ -16,7 +16,10 @@
  * You should have received a copy of the GNU General Public License
  * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
  */
+#include <algorithm>
 #include <cstdint>
+#include <type_traits>
+#include <vector>
 
 #include "catch2/catch.hpp"
 #include "libsanjego/gameobjects.hpp"
@@ -334,3 +337,256 @@ TEST_CASE("A player without tower should have max height 0", "[fast]") {
 
   REQUIRE(height_of_highest_yellow_tower == 0);
 }
+
+TEST_CASE("Making a move changes the board's hash", "[fast]") {
+  Board<2, 2> board;
+  const auto original_hash = board.hash();
+
+  Move move{{0, 0}, {0, 1}};
+  board.Make(move);
+
+  REQUIRE(board.hash() != original_hash);
+}
+
+TEST_CASE("Reverting a move restores the board's hash", "[fast]") {
+  Board<3, 4> board;
+  const auto original_hash = board.hash();
+
+  Move move{{1, 1}, {1, 2}};
+  board.Make(move);
+  board.Undo(move);
+
+  REQUIRE(board.hash() == original_hash);
+}
+
+TEST_CASE("Transposed move orders lead to the same hash", "[fast]") {
+  Board<3, 3> board;
+  Board<3, 3> transposed_board;
+
+  Move blue_move{{0, 0}, {0, 1}};
+  Move yellow_move{{1, 2}, {2, 2}};
+  board.Make(blue_move);
+  board.Make(yellow_move);
+
+  Move transposed_yellow_move{{1, 2}, {2, 2}};
+  Move transposed_blue_move{{0, 0}, {0, 1}};
+  transposed_board.Make(transposed_yellow_move);
+  transposed_board.Make(transposed_blue_move);
+
+  REQUIRE(board.hash() == transposed_board.hash());
+}
+
+TEST_CASE("Different stacking orders lead to different hashes", "[fast]") {
+  // the same two towers are stacked onto each other, but in reverse order
+  Board<1, 3> board;
+  Board<1, 3> other_board;
+
+  Move blue_move{{0, 0}, {0, 1}};
+  board.Make(blue_move);
+  Move yellow_move{{0, 1}, {0, 0}};
+  other_board.Make(yellow_move);
+
+  REQUIRE(board.hash() != other_board.hash());
+}
+
+TEST_CASE("Each move reduces the number of towers by one", "[fast]") {
+  Board<3, 4> board;
+  REQUIRE(board.num_towers() == 12);
+
+  Move move{{1, 1}, {1, 2}};
+  board.Make(move);
+  REQUIRE(board.num_towers() == 11);
+
+  board.Undo(move);
+  REQUIRE(board.num_towers() == 12);
+}
+
+TEST_CASE("Small boards should use bitboards", "[fast]") {
+  REQUIRE(Board<8, 8>::USES_BITBOARDS);
+  REQUIRE(Board<1, 64>::USES_BITBOARDS);
+  REQUIRE_FALSE(Board<9, 9>::USES_BITBOARDS);
+}
+
+TEST_CASE("Bitboards should follow the towers on the board", "[fast]") {
+  // |B|Y|B|    |_|B2|B|
+  // |Y|B|Y| -> |Y|Y2|_|
+  Board<2, 3> board;
+  REQUIRE(board.occupied() == 0b111111);
+  REQUIRE(board.OwnedBy(Color::Blue) == 0b010101);
+  REQUIRE(board.OwnedBy(Color::Yellow) == 0b101010);
+
+  Move blue_move{{0, 0}, {0, 1}};
+  Move yellow_move{{1, 2}, {1, 1}};
+  board.Make(blue_move);
+  board.Make(yellow_move);
+  REQUIRE(board.occupied() == 0b011110);
+  REQUIRE(board.OwnedBy(Color::Blue) == 0b000110);
+  REQUIRE(board.OwnedBy(Color::Yellow) == 0b011000);
+  REQUIRE(board.MaxHeightOf(Color::Blue) == 2);
+  REQUIRE(board.MaxHeightOf(Color::Yellow) == 2);
+
+  board.Undo(yellow_move);
+  board.Undo(blue_move);
+  REQUIRE(board.occupied() == 0b111111);
+  REQUIRE(board.OwnedBy(Color::Blue) == 0b010101);
+  REQUIRE(board.OwnedBy(Color::Yellow) == 0b101010);
+}
+
+TEST_CASE("Large boards should compute max heights without bitboards",
+          "[fast]") {
+  Board<9, 9> board;
+  Move blue_move{{8, 8}, {8, 7}};
+  board.Make(blue_move);
+  REQUIRE(board.MaxHeightOf(Color::Blue) == 2);
+  REQUIRE(board.MaxHeightOf(Color::Yellow) == 1);
+}
+
+TEST_CASE("Boards should be copyable byte by byte", "[fast]") {
+  STATIC_REQUIRE(std::is_trivially_copyable_v<Board<3, 3>>);
+  STATIC_REQUIRE(std::is_trivially_copyable_v<Board<9, 9>>);
+
+  Board<9, 9> board;
+  Move move{{0, 0}, {0, 1}};
+  board.Make(move);
+  const auto copy = board;
+  REQUIRE(copy.hash() == board.hash());
+  REQUIRE(copy.num_towers() == board.num_towers());
+  REQUIRE(copy.GetTowerAt({0, 1})->height() == 2);
+}
+
+TEST_CASE("Boards should be usable in constant expressions", "[fast]") {
+  constexpr Board<3, 3> board;
+  STATIC_REQUIRE(board.num_towers() == 9);
+  STATIC_REQUIRE(board.occupied() == 0b111111111);
+
+  constexpr auto blue_height = [] {
+    Board<3, 3> board;
+    Move move{{0, 0}, {0, 1}};
+    board.Make(move);
+    return board.MaxHeightOf(Color::Blue);
+  }();
+  STATIC_REQUIRE(blue_height == 2);
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+tower_size_t ScannedMaxHeightOf(const Board<HEIGHT, WIDTH> &board,
+                                const Color owner) {
+  tower_size_t max_height = 0;
+  for (const Tower &tower : board.fields()) {
+    if (tower.top() == owner) {
+      max_height = std::max(max_height, tower.height());
+    }
+  }
+  return max_height;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+void RequireTrackedMaxHeightsAfterStacking() {
+  Board<HEIGHT, WIDTH> board;
+  std::vector<Move> moves;
+  uint32_t seed = 12345;
+  while (board.num_towers() > 1) {
+    seed = seed * 1103515245 + 12345;
+    const auto source_index = seed % (HEIGHT * WIDTH);
+    const auto target_index = (seed >> 8) % (HEIGHT * WIDTH);
+    Move move{{static_cast<board_size_t>(source_index / WIDTH),
+               static_cast<board_size_t>(source_index % WIDTH)},
+              {static_cast<board_size_t>(target_index / WIDTH),
+               static_cast<board_size_t>(target_index % WIDTH)}};
+    if (not board.GetTowerAt(move.source) ||
+        not board.GetTowerAt(move.target) || not board.Make(move)) {
+      continue;
+    }
+    moves.push_back(move);
+    REQUIRE(board.MaxHeightOf(Color::Blue) ==
+            ScannedMaxHeightOf(board, Color::Blue));
+    REQUIRE(board.MaxHeightOf(Color::Yellow) ==
+            ScannedMaxHeightOf(board, Color::Yellow));
+  }
+  REQUIRE(std::max(board.MaxHeightOf(Color::Blue),
+                   board.MaxHeightOf(Color::Yellow)) == HEIGHT * WIDTH);
+
+  while (not moves.empty()) {
+    REQUIRE(board.Undo(moves.back()));
+    moves.pop_back();
+    REQUIRE(board.MaxHeightOf(Color::Blue) ==
+            ScannedMaxHeightOf(board, Color::Blue));
+    REQUIRE(board.MaxHeightOf(Color::Yellow) ==
+            ScannedMaxHeightOf(board, Color::Yellow));
+  }
+  REQUIRE(board.MaxHeightOf(Color::Blue) == 1);
+  REQUIRE(board.MaxHeightOf(Color::Yellow) == 1);
+}
+
+TEST_CASE("Tracked max heights should match a scan of the board", "[fast]") {
+  RequireTrackedMaxHeightsAfterStacking<3, 3>();
+  RequireTrackedMaxHeightsAfterStacking<9, 9>();
+  RequireTrackedMaxHeightsAfterStacking<12, 12>();
+}
+
+TEST_CASE("Packed moves should take two bytes", "[fast]") {
+  STATIC_REQUIRE(sizeof(PackedMove) == 2);
+  STATIC_REQUIRE(std::is_trivially_copyable_v<PackedMove>);
+}
+
+TEST_CASE("Moves to neighbours should survive packing", "[fast]") {
+  for (const Move &move : {Move{{1, 1}, {2, 1}}, Move{{1, 1}, {0, 1}},
+                           Move{{1, 1}, {1, 2}}, Move{{1, 1}, {1, 0}}}) {
+    REQUIRE(UnpackMove<3, 4>(PackMove<3, 4>(move)) == move);
+  }
+  REQUIRE(PackMove<3, 4>(Move::Skip()).IsSkip());
+  REQUIRE(UnpackMove<3, 4>(PackedMove::Skip()).IsSkip());
+  // not a neighbour
+  REQUIRE(PackMove<3, 4>(Move{{0, 0}, {1, 1}}).IsSkip());
+}
+
+TEST_CASE("Packed moves should be undone by the board", "[fast]") {
+  Board<3, 4> board;
+  const auto original_hash = board.hash();
+  const auto blue_move = PackMove<3, 4>(Move{{1, 1}, {1, 2}});
+  const auto yellow_move = PackMove<3, 4>(Move{{0, 1}, {0, 2}});
+  REQUIRE(board.Make(blue_move));
+  REQUIRE(board.Make(yellow_move));
+  REQUIRE(board.GetTowerAt({0, 2})->height() == 2);
+  REQUIRE(board.GetTowerAt({0, 2})->top() == Color::Yellow);
+
+  REQUIRE(board.Undo());
+  REQUIRE(board.GetTowerAt({0, 2})->height() == 1);
+  REQUIRE(board.GetTowerAt({0, 2})->top() == Color::Blue);
+  REQUIRE(board.GetTowerAt({1, 2})->height() == 2);
+  REQUIRE(board.Undo());
+  REQUIRE(board.hash() == original_hash);
+  REQUIRE(board.num_towers() == 12);
+  REQUIRE(board.GetTowerAt({1, 1})->top() == Color::Blue);
+  REQUIRE(board.GetTowerAt({1, 2})->top() == Color::Yellow);
+  REQUIRE_FALSE(board.Undo());
+}
+
+TEST_CASE("Packed moves over the border should not be made", "[fast]") {
+  Board<3, 4> board;
+  REQUIRE_FALSE(board.Make(PackedMove{3, Direction::Right}));
+  REQUIRE_FALSE(board.Make(PackedMove{4, Direction::Left}));
+  REQUIRE_FALSE(board.Make(PackedMove{1, Direction::Up}));
+  REQUIRE_FALSE(board.Make(PackedMove{9, Direction::Down}));
+  REQUIRE_FALSE(board.Make(PackedMove::Skip()));
+  REQUIRE(board.num_towers() == 12);
+  REQUIRE_FALSE(board.Undo());
+}
+
+TEST_CASE("Neighbour tables should be computed at compile time", "[fast]") {
+  // |0|1| 2| 3|
+  // |4|5| 6| 7|
+  // |8|9|10|11|
+  constexpr auto &neighbours = details::NEIGHBOURS<3, 4>;
+  STATIC_REQUIRE(neighbours.size() == 4 * 12);
+  STATIC_REQUIRE(details::TargetIndexOf<3, 4>({5, Direction::Down}) == 9);
+  STATIC_REQUIRE(details::TargetIndexOf<3, 4>({5, Direction::Up}) == 1);
+  STATIC_REQUIRE(details::TargetIndexOf<3, 4>({5, Direction::Right}) == 6);
+  STATIC_REQUIRE(details::TargetIndexOf<3, 4>({5, Direction::Left}) == 4);
+  STATIC_REQUIRE(details::TargetIndexOf<3, 4>({3, Direction::Right}) ==
+                 details::NO_NEIGHBOUR);
+  STATIC_REQUIRE(details::TargetIndexOf<3, 4>({8, Direction::Down}) ==
+                 details::NO_NEIGHBOUR);
+  STATIC_REQUIRE_FALSE(details::StaysOnBoard<3, 4>({12, Direction::Up}));
+  STATIC_REQUIRE_FALSE(details::StaysOnBoard<3, 4>(PackedMove::Skip()));
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/ordering.hpp"
+#include "libsanjego/rulesets.hpp"
+
+// To make the test cases more readable
+using namespace libsanjego;
+
+TEST_CASE("The hash move should be ordered first", "[fast]") {
+  const Board<3, 3> board;
+  StandardRuleset<3, 3> rules;
+  MoveOrdering<3, 3> ordering;
+  auto moves = rules.GetLegalPackedMoves(board, Color::Blue);
+  const auto hash_move = moves.back();
+  ordering.Order(moves, board, hash_move, 0);
+  REQUIRE(moves.front() == hash_move);
+}
+
+TEST_CASE("Captures of taller towers should be ordered first", "[fast]") {
+  // |B|Y|B|    |Y2|_|B|
+  // |Y|B|Y| -> |B2|_|Y|
+  // |B|Y|B|    |B |Y|B|
+  Board<3, 3> board;
+  Move blue_move{{1, 1}, {1, 0}};
+  Move yellow_move{{0, 1}, {0, 0}};
+  REQUIRE(board.Make(blue_move));
+  REQUIRE(board.Make(yellow_move));
+  StandardRuleset<3, 3> rules;
+  MoveOrdering<3, 3> ordering;
+  auto moves = rules.GetLegalPackedMoves(board, Color::Blue);
+  ordering.Order(moves, board, PackedMove::Skip(), 0);
+  REQUIRE(moves.front() == PackMove<3, 3>(Move{{1, 0}, {0, 0}}));
+}
+
+TEST_CASE("Moves that caused cutoffs should be ordered early", "[fast]") {
+  // |B|Y|B|    |B|B2|B|
+  // |Y|B|Y| -> |_|_ |Y|
+  // |B|Y|B|    |Y2|Y|B|
+  Board<3, 3> board;
+  Move blue_move{{1, 1}, {0, 1}};
+  Move yellow_move{{1, 0}, {2, 0}};
+  REQUIRE(board.Make(blue_move));
+  REQUIRE(board.Make(yellow_move));
+  StandardRuleset<3, 3> rules;
+  MoveOrdering<3, 3> ordering;
+  auto moves = rules.GetLegalPackedMoves(board, Color::Blue);
+  // Blue can capture three yellow towers, which are always tried first, and
+  // has four moves onto its own towers.
+  REQUIRE(moves.size() == 7);
+  const auto cutoff_move = PackMove<3, 3>(Move{{0, 2}, {0, 1}});
+  ordering.RecordCutoff(board, cutoff_move, 3, 2);
+
+  SECTION("as killer moves at the same ply") {
+    ordering.Order(moves, board, PackedMove::Skip(), 3);
+    REQUIRE(moves[3] == cutoff_move);
+  }
+  SECTION("by their history at other plies") {
+    ordering.Order(moves, board, PackedMove::Skip(), 4);
+    REQUIRE(moves[3] == cutoff_move);
+  }
+  SECTION("but not before the hash move") {
+    const auto hash_move = PackMove<3, 3>(Move{{0, 0}, {0, 1}});
+    ordering.Order(moves, board, hash_move, 3);
+    REQUIRE(moves[0] == hash_move);
+    REQUIRE(moves[4] == cutoff_move);
+  }
+}
+
+TEST_CASE("Staged moves hand out all legal moves in order", "[fast]") {
+  const Board<3, 3> board;
+  StandardRuleset<3, 3> rules;
+  MoveOrdering<3, 3> ordering;
+  auto expected_moves = rules.GetLegalPackedMoves(board, Color::Blue);
+  const auto hash_move = expected_moves.back();
+  ordering.Order(expected_moves, board, hash_move, 0);
+
+  StagedMoves<3, 3> moves(rules, ordering, board, Color::Blue, hash_move, 0);
+  REQUIRE(moves.HasAny());
+  std::vector<PackedMove> handed_out_moves;
+  while (const auto move = moves.Next()) {
+    handed_out_moves.push_back(move.value());
+  }
+  REQUIRE(handed_out_moves == expected_moves);
+  const auto all_moves = moves.All();
+  REQUIRE(std::vector<PackedMove>(all_moves.begin(), all_moves.end()) ==
+          expected_moves);
+}
+
+TEST_CASE("Staged moves ignore illegal hash moves", "[fast]") {
+  const Board<3, 3> board;
+  StandardRuleset<3, 3> rules;
+  MoveOrdering<3, 3> ordering;
+  // the tower in the center is blue
+  const auto hash_move = PackMove<3, 3>(Move{{1, 1}, {0, 1}});
+  StagedMoves<3, 3> moves(rules, ordering, board, Color::Yellow, hash_move, 0);
+  REQUIRE(moves.Next().value() != hash_move);
+  REQUIRE(moves.All().size() ==
+          rules.GetLegalPackedMoves(board, Color::Yellow).size());
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "catch2/catch.hpp"
+#include "libsanjego/bot.hpp"
+#include "libsanjego/deadline.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/mcts.hpp"
+#include "libsanjego/ponder.hpp"
+
+// To make the test cases more readable
+using namespace libsanjego;
+
+TEST_CASE("A search should stop once its deadline is moved", "[fast]") {
+  const Board<9, 9> board;
+  FullExplorer<9, 9> explorer;
+  Deadline deadline;
+  std::thread search([&] { explorer.Explore(board, Color::Blue, deadline); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  const auto stop_time = std::chrono::steady_clock::now();
+  deadline.MoveTo(stop_time);
+  search.join();
+  const std::chrono::duration<double> delay =
+      std::chrono::steady_clock::now() - stop_time;
+  REQUIRE(delay.count() < 0.5);
+}
+
+TEST_CASE("Pondering should continue on the expected move", "[fast]") {
+  Board<4, 4> board;
+  FullExplorer<4, 4> explorer;
+  const auto result = explorer.Explore(board, Color::Blue,
+                                       std::chrono::milliseconds(20));
+  REQUIRE(result.principal_variation.size() >= 2);
+  auto own_move = result.best_move;
+  board.Make(own_move);
+
+  Ponderer<4, 4> ponderer(explorer);
+  REQUIRE(ponderer.Start(board, Color::Yellow,
+                         result.principal_variation[1]));
+  REQUIRE(ponderer.is_pondering());
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  auto reply = result.principal_variation[1];
+  board.Make(reply);
+  const auto ponder_result = ponderer.Explore(
+      board, Color::Blue,
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(20));
+  REQUIRE(ponderer.num_hits() == 1);
+  REQUIRE(ponderer.num_misses() == 0);
+  REQUIRE_FALSE(ponderer.is_pondering());
+  // the pondering time counts as well
+  REQUIRE(ponder_result.seconds_spent >= 0.04);
+  REQUIRE_FALSE(ponder_result.best_move.IsSkip());
+}
+
+TEST_CASE("Pondering should start over on an unexpected move", "[fast]") {
+  Board<4, 4> board;
+  MctsExplorer<4, 4> explorer(500, 1);
+  Move own_move{{0, 0}, {0, 1}};
+  board.Make(own_move);
+  StandardRuleset<4, 4> rules;
+  const auto replies = rules.GetLegalMoves(board, Color::Yellow);
+  REQUIRE(replies.size() >= 2);
+
+  Ponderer<4, 4> ponderer(explorer);
+  REQUIRE(ponderer.Start(board, Color::Yellow, replies[0]));
+  auto reply = replies[1];
+  board.Make(reply);
+  const auto result = ponderer.Explore(
+      board, Color::Blue,
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(20));
+  REQUIRE(ponderer.num_hits() == 0);
+  REQUIRE(ponderer.num_misses() == 1);
+  const auto legal_moves = rules.GetLegalMoves(board, Color::Blue);
+  REQUIRE(std::find(legal_moves.begin(), legal_moves.end(),
+                    result.best_move) != legal_moves.end());
+}
+
+TEST_CASE("Pondering should not start on an illegal move", "[fast]") {
+  const Board<3, 3> board;
+  FullExplorer<3, 3> explorer;
+  Ponderer<3, 3> ponderer(explorer);
+  // the opponent does not own the tower in the corner
+  REQUIRE_FALSE(ponderer.Start(board, Color::Yellow, Move{{0, 0}, {0, 1}}));
+  REQUIRE_FALSE(ponderer.is_pondering());
+}
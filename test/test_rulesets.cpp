@@ -188,4 +188,177 @@ TEST_CASE("A player owns a tower iff the top brick has their color", "[fast]") {
     REQUIRE(ruleset.OwnsTower(Color::Yellow, yellow_tower));
     REQUIRE_FALSE(ruleset.OwnsTower(Color::Blue, yellow_tower));
   }
-}
\ No newline at end of file
+}
+TEST_CASE("Final values of a finished game are bounded by its value",
+          "[fast]") {
+  Board<1, 2> board;
+  auto ruleset = CreateStandardRulesetFor(board);
+  Move move{{0, 0}, {0, 1}};
+  board.Make(move);
+
+  const auto [lower_bound, upper_bound] = ruleset->BoundFinalValueOf(board);
+  REQUIRE(lower_bound == 2);
+  REQUIRE(upper_bound == 2);
+}
+
+TEST_CASE("Final values are bounded by the sizes of groups of towers",
+          "[fast]") {
+  const Board<2, 2> board;
+  auto ruleset = CreateStandardRulesetFor(board);
+
+  // any color could stack all four bricks
+  const auto [lower_bound, upper_bound] = ruleset->BoundFinalValueOf(board);
+  REQUIRE(lower_bound == -4);
+  REQUIRE(upper_bound == 4);
+}
+
+TEST_CASE("Isolated towers bound the final value", "[fast]") {
+  // results in |B|_|Y| with both towers isolated from each other
+  Board<1, 3> board;
+  auto ruleset = CreateStandardRulesetFor(board);
+  Move move{{0, 1}, {0, 2}};
+  board.Make(move);
+
+  const auto [lower_bound, upper_bound] = ruleset->BoundFinalValueOf(board);
+  REQUIRE(lower_bound == -1);
+  REQUIRE(upper_bound == -1);
+}
+
+TEST_CASE("Values after moves match the values of the resulting boards",
+          "[fast]") {
+  uint32_t seed = 42;
+  for (int game = 0; game < 20; ++game) {
+    Board<3, 4> board;
+    auto ruleset = CreateStandardRulesetFor(board);
+    auto active_player = Color::Blue;
+    while (true) {
+      for (const auto player : {Color::Blue, Color::Yellow}) {
+        const auto moves = ruleset->GetLegalPackedMoves(board, player);
+        std::vector<int8_t> values(moves.size());
+        ruleset->ComputeValuesAfter(board, moves, values);
+        for (std::size_t index = 0; index < moves.size(); ++index) {
+          board.Make(moves[index]);
+          REQUIRE(values[index] == ruleset->ComputeValueOf(board));
+          board.Undo();
+        }
+      }
+
+      auto moves = ruleset->GetLegalMoves(board, active_player);
+      active_player =
+          active_player == Color::Blue ? Color::Yellow : Color::Blue;
+      if (moves.empty()) {
+        if (ruleset->GetLegalMoves(board, active_player).empty()) {
+          break;
+        }
+        continue;
+      }
+      seed = seed * 1103515245 + 12345;
+      board.Make(moves[(seed >> 8) % moves.size()]);
+    }
+  }
+}
+
+TEST_CASE("Packed legal moves are the legal moves in the same order",
+          "[fast]") {
+  Board<3, 4> board;
+  auto ruleset = CreateStandardRulesetFor(board);
+  Move blue_move{{1, 1}, {1, 2}};
+  Move yellow_move{{0, 1}, {0, 0}};
+  board.Make(blue_move);
+  board.Make(yellow_move);
+
+  for (const auto player : {Color::Blue, Color::Yellow}) {
+    const auto moves = ruleset->GetLegalMoves(board, player);
+    const auto packed_moves = ruleset->GetLegalPackedMoves(board, player);
+    REQUIRE(packed_moves.size() == moves.size());
+    for (std::size_t index = 0; index < moves.size(); ++index) {
+      REQUIRE(UnpackMove<3, 4>(packed_moves[index]) == moves[index]);
+    }
+  }
+}
+
+TEST_CASE("Generated legal moves are the packed legal moves", "[fast]") {
+  Board<3, 4> board;
+  auto ruleset = CreateStandardRulesetFor(board);
+  Move blue_move{{1, 1}, {1, 2}};
+  Move yellow_move{{0, 1}, {0, 0}};
+  board.Make(blue_move);
+  board.Make(yellow_move);
+
+  for (const auto player : {Color::Blue, Color::Yellow}) {
+    const auto packed_moves = ruleset->GetLegalPackedMoves(board, player);
+    MoveList<3, 4> moves;
+    ruleset->GenerateLegalMoves(board, player, moves);
+    REQUIRE(std::vector<PackedMove>(moves.begin(), moves.end()) ==
+            packed_moves);
+    REQUIRE(ruleset->HasLegalMoves(board, player));
+  }
+}
+
+TEST_CASE("No legal moves are generated in an end state", "[fast]") {
+  Board<1, 1> board;
+  auto ruleset = CreateStandardRulesetFor(board);
+  for (const auto player : {Color::Blue, Color::Yellow}) {
+    MoveList<1, 1> moves;
+    ruleset->GenerateLegalMoves(board, player, moves);
+    REQUIRE(moves.empty());
+    REQUIRE_FALSE(ruleset->HasLegalMoves(board, player));
+  }
+}
+
+namespace {
+/*
+ * Plays random games and checks in each position that the generated moves
+ * are exactly the moves to neighbours that are allowed.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+void RequireGeneratedMovesAreAllowed(uint32_t seed) {
+  for (int game = 0; game < 5; ++game) {
+    Board<HEIGHT, WIDTH> board;
+    auto ruleset = CreateStandardRulesetFor(board);
+    auto active_player = Color::Blue;
+    while (true) {
+      for (const auto player : {Color::Blue, Color::Yellow}) {
+        std::vector<Move> allowed_moves;
+        for (board_size_t row = 0; row < HEIGHT; ++row) {
+          for (board_size_t col = 0; col < WIDTH; ++col) {
+            for (const auto &move :
+                 details::GetMovesToQuadNeighboursOn(board, {row, col})) {
+              if (ruleset->MoveIsAllowedOn(board, move, player)) {
+                allowed_moves.push_back(move);
+              }
+            }
+          }
+        }
+        REQUIRE(ruleset->GetLegalMoves(board, player) == allowed_moves);
+        REQUIRE(ruleset->HasLegalMoves(board, player) ==
+                not allowed_moves.empty());
+      }
+
+      auto moves = ruleset->GetLegalMoves(board, active_player);
+      active_player =
+          active_player == Color::Blue ? Color::Yellow : Color::Blue;
+      if (moves.empty()) {
+        if (ruleset->GetLegalMoves(board, active_player).empty()) {
+          break;
+        }
+        continue;
+      }
+      seed = seed * 1103515245 + 12345;
+      board.Make(moves[(seed >> 8) % moves.size()]);
+    }
+  }
+}
+}  // namespace
+
+TEST_CASE("Generated moves are the allowed moves to neighbours", "[fast]") {
+  SECTION("with bitboards") {
+    RequireGeneratedMovesAreAllowed<4, 4>(1);
+    RequireGeneratedMovesAreAllowed<3, 5>(2);
+    RequireGeneratedMovesAreAllowed<8, 8>(3);
+    RequireGeneratedMovesAreAllowed<1, 64>(4);
+  }
+  SECTION("without bitboards") {
+    RequireGeneratedMovesAreAllowed<9, 9>(5);
+  }
+}
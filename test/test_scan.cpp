@@ -0,0 +1,91 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+
+#include "catch2/catch.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/scan.hpp"
+
+// To make the test cases more readable
+using namespace libsanjego;
+
+namespace {
+/*
+ * Stacks random neighbours until only a few towers are left, which leaves
+ * towers of all kinds of heights and owners behind.
+ */
+template <board_size_t HEIGHT, board_size_t WIDTH>
+Board<HEIGHT, WIDTH> StackedBoard(uint32_t seed) {
+  Board<HEIGHT, WIDTH> board;
+  for (uint32_t attempt = 0; attempt < 20 * HEIGHT * WIDTH; ++attempt) {
+    seed = seed * 1103515245 + 12345;
+    const auto index = (seed >> 8) % (HEIGHT * WIDTH);
+    const Position source{board_size_t(index / WIDTH),
+                          board_size_t(index % WIDTH)};
+    const auto horizontal = (seed >> 28) % 2 == 0;
+    const Position target{board_size_t(source.row + (horizontal ? 0 : 1)),
+                          board_size_t(source.column + (horizontal ? 1 : 0))};
+    if (board.GetTowerAt(source) && board.GetTowerAt(target)) {
+      Move move{source, target};
+      board.Make(move);
+    }
+  }
+  return board;
+}
+
+template <board_size_t HEIGHT, board_size_t WIDTH>
+void RequireAllKernelsToAgree(const Board<HEIGHT, WIDTH> &board) {
+  for (const auto owner : {Color::Blue, Color::Yellow}) {
+    const auto expected = details::ScanTowersWith(details::SimdLevel::Scalar,
+                                                  board.fields(), owner);
+    REQUIRE(expected.max_height == board.MaxHeightOf(owner));
+    for (const auto level :
+         {details::SimdLevel::Sse41, details::SimdLevel::Avx2}) {
+      if (level <= details::DetectedSimdLevel()) {
+        REQUIRE(details::ScanTowersWith(level, board.fields(), owner) ==
+                expected);
+      }
+    }
+    REQUIRE(ScanTowersOf(board.fields(), owner) == expected);
+    REQUIRE(CountTowersOf(board, owner) == expected.num_towers);
+  }
+}
+}  // namespace
+
+TEST_CASE("Scanning a new board should find all towers", "[fast]") {
+  const Board<9, 9> board;
+  REQUIRE(ScanTowersOf(board.fields(), Color::Blue) == OwnerScan{1, 41});
+  REQUIRE(ScanTowersOf(board.fields(), Color::Yellow) == OwnerScan{1, 40});
+}
+
+TEST_CASE("Vectorized scans should agree with the scalar one", "[fast]") {
+  for (uint32_t seed = 1; seed <= 5; ++seed) {
+    // sizes that fill whole vectors as well as ones that leave a tail
+    RequireAllKernelsToAgree(StackedBoard<4, 4>(seed));
+    RequireAllKernelsToAgree(StackedBoard<5, 7>(seed));
+    RequireAllKernelsToAgree(StackedBoard<9, 9>(seed));
+    RequireAllKernelsToAgree(StackedBoard<16, 16>(seed));
+  }
+}
+
+TEST_CASE("Scanning a board without towers should find nothing", "[fast]") {
+  const Board<1, 1> board;
+  REQUIRE(ScanTowersOf(board.fields().subspan(1), Color::Blue) ==
+          OwnerScan{0, 0});
+}
@@ -0,0 +1,75 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include <cstdint>
+
+#include "catch2/catch.hpp"
+#include "libsanjego/scheduler.hpp"
+
+// To make the test cases more readable
+using namespace libsanjego;
+
+TEST_CASE("A scheduler has at least one worker", "[fast]") {
+  const WorkStealingScheduler scheduler(0);
+  REQUIRE(scheduler.num_workers() == 1);
+}
+
+TEST_CASE("The creating thread is worker 0", "[fast]") {
+  const WorkStealingScheduler scheduler(3);
+  REQUIRE(scheduler.CurrentWorkerIndex() == 0);
+}
+
+TEST_CASE("All spawned tasks are run", "[fast]") {
+  for (unsigned int num_workers = 1; num_workers <= 4; ++num_workers) {
+    WorkStealingScheduler scheduler(num_workers);
+    std::atomic<int> num_pending_tasks = 100;
+    for (int i = 0; i < 100; ++i) {
+      scheduler.Spawn([&num_pending_tasks] { --num_pending_tasks; });
+    }
+    scheduler.HelpUntil([&num_pending_tasks] { return num_pending_tasks == 0; });
+    REQUIRE(num_pending_tasks == 0);
+  }
+}
+
+// Sums up 1..n by recursively splitting the range into tasks.
+uint64_t SumUpTo(WorkStealingScheduler &scheduler, const uint64_t from,
+                 const uint64_t to) {
+  if (to - from < 8) {
+    uint64_t sum = 0;
+    for (auto i = from; i <= to; ++i) {
+      sum += i;
+    }
+    return sum;
+  }
+  const auto middle = from + (to - from) / 2;
+  std::atomic<bool> done = false;
+  uint64_t upper_sum = 0;
+  scheduler.Spawn([&scheduler, &done, &upper_sum, middle, to] {
+    upper_sum = SumUpTo(scheduler, middle + 1, to);
+    done = true;
+  });
+  const auto lower_sum = SumUpTo(scheduler, from, middle);
+  scheduler.HelpUntil([&done] { return done.load(); });
+  return lower_sum + upper_sum;
+}
+
+TEST_CASE("Tasks can wait for tasks they spawned", "[fast]") {
+  WorkStealingScheduler scheduler(4);
+  REQUIRE(SumUpTo(scheduler, 1, 1000) == 500500);
+}
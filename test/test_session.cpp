@@ -0,0 +1,90 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+
+#include "catch2/catch.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/session.hpp"
+
+// To make the test cases more readable
+using namespace libsanjego;
+
+TEST_CASE("Sessions should reject unsupported board sizes", "[fast]") {
+  REQUIRE(CreateSession(0, 5) == nullptr);
+  REQUIRE(CreateSession(5, 0) == nullptr);
+  REQUIRE(CreateSession(MAX_SESSION_HEIGHT + 1, 5) == nullptr);
+  REQUIRE(CreateSession(5, MAX_SESSION_WIDTH + 1) == nullptr);
+}
+
+TEST_CASE("Sessions should exist for all supported board sizes", "[fast]") {
+  for (board_size_t height = 1; height <= MAX_SESSION_HEIGHT; ++height) {
+    for (board_size_t width = 1; width <= MAX_SESSION_WIDTH; ++width) {
+      const auto session = CreateSession(height, width, Engine::AlphaBeta, 1);
+      REQUIRE(session != nullptr);
+      REQUIRE(session->height() == height);
+      REQUIRE(session->width() == width);
+      REQUIRE(session->GetTowerAt({RowNr(height - 1), ColumnNr(width - 1)}));
+      REQUIRE_FALSE(session->GetTowerAt({RowNr(height), ColumnNr(0)}));
+    }
+  }
+}
+
+TEST_CASE("Sessions should play by the standard rules", "[fast]") {
+  const auto session = CreateSession(3, 4);
+  REQUIRE(session != nullptr);
+  const StandardRuleset<3, 4> rules;
+  Board<3, 4> board;
+  REQUIRE(session->active_player() == Color::Blue);
+  REQUIRE(session->GetLegalMoves() == rules.GetLegalMoves(board, Color::Blue));
+
+  SECTION("Illegal moves are rejected") {
+    REQUIRE_FALSE(session->Make(Move{{0, 0}, {2, 2}}));
+    REQUIRE_FALSE(session->Make(Move::Skip()));
+    REQUIRE(session->active_player() == Color::Blue);
+  }
+  SECTION("Legal moves pass the turn on") {
+    auto move = rules.GetLegalMoves(board, Color::Blue).front();
+    REQUIRE(session->Make(move));
+    board.Make(move);
+    REQUIRE(session->active_player() == Color::Yellow);
+    REQUIRE(session->GetLegalMoves() ==
+            rules.GetLegalMoves(board, Color::Yellow));
+    REQUIRE(session->value() == rules.ComputeValueOf(board));
+  }
+}
+
+TEST_CASE("Sessions should play games to their end", "[fast]") {
+  const auto engine = GENERATE(Engine::AlphaBeta, Engine::MonteCarlo);
+  const auto session = CreateSession(2, 3, engine, 1);
+  REQUIRE(session != nullptr);
+  while (not session->IsOver()) {
+    const auto legal_moves = session->GetLegalMoves();
+    const auto best_move = session->Explore().best_move;
+    if (legal_moves.empty()) {
+      REQUIRE(best_move.IsSkip());
+    } else {
+      REQUIRE(std::find(legal_moves.begin(), legal_moves.end(), best_move) !=
+              legal_moves.end());
+    }
+    REQUIRE(session->Make(best_move));
+  }
+  REQUIRE(session->GetLegalMoves().empty());
+  REQUIRE_FALSE(session->Make(Move::Skip()));
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "libsanjego/bot.hpp"
+#include "libsanjego/gameobjects.hpp"
+#include "libsanjego/rulesets.hpp"
+#include "libsanjego/symmetry.hpp"
+
+// To make the test cases more readable
+using namespace libsanjego;
+
+namespace {
+// |B|B2|B|
+// |_|_ |Y|
+// |Y2|Y|B|
+Board<3, 3> AsymmetricBoard() {
+  Board<3, 3> board;
+  Move blue_move{{1, 1}, {0, 1}};
+  Move yellow_move{{1, 0}, {2, 0}};
+  board.Make(blue_move);
+  board.Make(yellow_move);
+  return board;
+}
+
+Color OpponentOf(const Color player) {
+  return player == Color::Blue ? Color::Yellow : Color::Blue;
+}
+}  // namespace
+
+TEST_CASE("Symmetries should permute all fields", "[fast]") {
+  for (const auto &permutation : details::SYMMETRY_PERMUTATIONS<3, 3>) {
+    std::vector<uint8_t> fields(permutation.begin(), permutation.end());
+    std::sort(fields.begin(), fields.end());
+    for (uint8_t field = 0; field < fields.size(); ++field) {
+      REQUIRE(fields[field] == field);
+    }
+  }
+  REQUIRE(NUM_SYMMETRIES<3, 3> == 8);
+  REQUIRE(NUM_SYMMETRIES<2, 3> == 4);
+}
+
+TEST_CASE("Equivalent positions should share their key", "[fast]") {
+  const auto board = AsymmetricBoard();
+  const auto key = CanonicalKeyOf(board, Color::Blue);
+  for (uint8_t transform = 0; transform < NUM_SYMMETRIES<3, 3>; ++transform) {
+    for (const bool swaps_colors : {false, true}) {
+      const Symmetry symmetry{transform, swaps_colors};
+      const auto player = swaps_colors ? Color::Yellow : Color::Blue;
+      const auto transformed = Transform(board, symmetry);
+      REQUIRE(CanonicalKeyOf(transformed, player).hash == key.hash);
+    }
+  }
+}
+
+TEST_CASE("Swapping colors should swap the max heights", "[fast]") {
+  auto board = AsymmetricBoard();
+  Move blue_move{{0, 0}, {0, 1}};
+  board.Make(blue_move);
+  const auto transformed = Transform(board, Symmetry{1, true});
+  REQUIRE(transformed.MaxHeightOf(Color::Yellow) == 3);
+  REQUIRE(transformed.MaxHeightOf(Color::Blue) == 2);
+}
+
+TEST_CASE("The key should be the hash of the representative", "[fast]") {
+  const auto board = AsymmetricBoard();
+  for (const auto player : {Color::Blue, Color::Yellow}) {
+    const auto key = CanonicalKeyOf(board, player);
+    REQUIRE(key.symmetry.swaps_colors == (player == Color::Yellow));
+    REQUIRE(key.hash == Transform(board, key.symmetry).hash());
+  }
+}
+
+TEST_CASE("Different positions should have different keys", "[fast]") {
+  Board<3, 3> center_moved;
+  Move center_move{{1, 1}, {0, 1}};
+  center_moved.Make(center_move);
+  Board<3, 3> corner_moved;
+  Move corner_move{{0, 0}, {0, 1}};
+  corner_moved.Make(corner_move);
+  REQUIRE(CanonicalKeyOf(center_moved, Color::Yellow).hash !=
+          CanonicalKeyOf(corner_moved, Color::Yellow).hash);
+  REQUIRE(CanonicalKeyOf(center_moved, Color::Yellow).hash !=
+          CanonicalKeyOf(center_moved, Color::Blue).hash);
+}
+
+TEST_CASE("Transformed moves should be legal on the transformed board",
+          "[fast]") {
+  const auto board = AsymmetricBoard();
+  StandardRuleset<3, 3> rules;
+  for (const auto player : {Color::Blue, Color::Yellow}) {
+    for (uint8_t transform = 0; transform < NUM_SYMMETRIES<3, 3>;
+         ++transform) {
+      for (const bool swaps_colors : {false, true}) {
+        const Symmetry symmetry{transform, swaps_colors};
+        const auto transformed = Transform(board, symmetry);
+        const auto transformed_player =
+            swaps_colors ? OpponentOf(player) : player;
+        const auto moves = rules.GetLegalMoves(board, player);
+        const auto transformed_moves =
+            rules.GetLegalMoves(transformed, transformed_player);
+        REQUIRE(moves.size() == transformed_moves.size());
+        for (const auto &move : moves) {
+          const auto transformed_move = Transform<3, 3>(move, symmetry);
+          REQUIRE(std::find(transformed_moves.begin(),
+                            transformed_moves.end(),
+                            transformed_move) != transformed_moves.end());
+          REQUIRE(Transform<3, 3>(transformed_move, InverseOf(symmetry)) ==
+                  move);
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Searches with symmetric keys should find the best move",
+          "[fast]") {
+  const Board<2, 3> board;
+  SECTION("Solving") {
+    SolvingExplorer<2, 3> explorer;
+    explorer.UseSymmetricKeys(true);
+    const auto result = explorer.Explore(board, Color::Blue);
+    REQUIRE(result.proven_value == 2);
+    REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+    const auto yellow_result = explorer.Explore(board, Color::Yellow);
+    REQUIRE(yellow_result.proven_value == -2);
+  }
+  SECTION("Depth-limited") {
+    FullExplorer<2, 3> explorer;
+    explorer.UseSymmetricKeys(true);
+    const auto result = explorer.Explore(board, Color::Blue);
+    REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+  }
+}
@@ -0,0 +1,145 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "catch2/catch.hpp"
+#include "libsanjego/bot.hpp"
+#include "libsanjego/tablebase.hpp"
+
+// To make the test cases more readable
+using namespace libsanjego;
+
+namespace {
+std::string TemporaryPathFor(const std::string &name) {
+  return (std::filesystem::temp_directory_path() / name).string();
+}
+}  // namespace
+
+TEST_CASE("Positions should be indexed without gaps", "[fast]") {
+  constexpr uint32_t num_fields = 9;
+  for (uint8_t num_towers = 1; num_towers <= 4; ++num_towers) {
+    const auto num_positions = details::NumPositionsWith(num_fields, num_towers);
+    for (uint64_t index = 0; index < num_positions; ++index) {
+      const auto position = details::PositionAt(index, num_fields, num_towers);
+      REQUIRE(details::IndexOf(position, num_fields) == index);
+    }
+  }
+}
+
+TEST_CASE("A generated tablebase should be loadable", "[fast]") {
+  const auto path = TemporaryPathFor("sanjego_test_2x3.sjtb");
+  REQUIRE(Tablebase<2, 3>::Generate(path, 3));
+  REQUIRE(std::filesystem::file_size(path) == Tablebase<2, 3>::FileSizeFor(3));
+  const auto tablebase = Tablebase<2, 3>::Load(path);
+  REQUIRE(tablebase.has_value());
+  REQUIRE(tablebase->max_towers() == 3);
+
+  SECTION("but not for other board sizes") {
+    REQUIRE_FALSE(Tablebase<3, 2>::Load(path).has_value());
+  }
+  SECTION("and should not answer for too many towers") {
+    const Board<2, 3> board;
+    REQUIRE_FALSE(tablebase->Probe(board, Color::Blue).has_value());
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Missing or broken tablebases should not be loaded", "[fast]") {
+  const auto path = TemporaryPathFor("sanjego_test_broken.sjtb");
+  std::filesystem::remove(path);
+  REQUIRE_FALSE(Tablebase<2, 3>::Load(path).has_value());
+  {
+    std::ofstream file(path, std::ios::binary);
+    file << "SJTB but not much else";
+  }
+  REQUIRE_FALSE(Tablebase<2, 3>::Load(path).has_value());
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("A tablebase should agree with a solver", "[fast]") {
+  const auto path = TemporaryPathFor("sanjego_test_3x3.sjtb");
+  REQUIRE(Tablebase<3, 3>::Generate(path, 4));
+  const auto tablebase = Tablebase<3, 3>::Load(path);
+  REQUIRE(tablebase.has_value());
+
+  StandardRuleset<3, 3> rules;
+  std::mt19937 random(42);
+  for (int game = 0; game < 20; ++game) {
+    Board<3, 3> board;
+    auto active_player = Color::Blue;
+    int num_skips = 0;
+    // plays randomly until the game is over
+    while (num_skips < 2) {
+      auto moves = rules.GetLegalMoves(board, active_player);
+      if (moves.empty()) {
+        ++num_skips;
+      } else {
+        num_skips = 0;
+        board.Make(moves[random() % moves.size()]);
+      }
+      active_player =
+          active_player == Color::Blue ? Color::Yellow : Color::Blue;
+      if (board.num_towers() <= tablebase->max_towers()) {
+        SolvingExplorer<3, 3> solver;
+        const auto expected =
+            solver.Explore(board, active_player).proven_value;
+        REQUIRE(tablebase->Probe(board, active_player) == expected);
+      }
+    }
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("Explorers should use a tablebase", "[fast]") {
+  const auto path = TemporaryPathFor("sanjego_test_2x3_explorers.sjtb");
+  REQUIRE(Tablebase<2, 3>::Generate(path, 4));
+  auto tablebase = Tablebase<2, 3>::Load(path);
+  REQUIRE(tablebase.has_value());
+  const auto shared_tablebase =
+      std::make_shared<const Tablebase<2, 3>>(std::move(tablebase.value()));
+
+  const Board<2, 3> board;
+  SECTION("when solving") {
+    SolvingExplorer<2, 3> explorer;
+    explorer.UseTablebase(shared_tablebase);
+    const auto result = explorer.Explore(board, Color::Blue);
+    REQUIRE(result.proven_value == 2);
+    REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+  }
+  SECTION("when searching to a fixed depth") {
+    // the tablebase covers everything beyond the second half-turn
+    FullExplorer<2, 3> explorer(2);
+    explorer.UseTablebase(shared_tablebase);
+    const auto result = explorer.Explore(board, Color::Blue);
+    REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+    REQUIRE(result.proven_value == 2);
+  }
+  SECTION("when searching in parallel") {
+    YbwcExplorer<2, 3> explorer(2, 2);
+    explorer.UseTablebase(shared_tablebase);
+    const auto result = explorer.Explore(board, Color::Blue);
+    REQUIRE(result.best_move == Move{{1, 1}, {0, 1}});
+  }
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2021 merkrafter
+ *
+ * This file is part of libsanjego.
+ *
+ * libsanjego is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * libsanjego is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with libsanjego. If not, see <https://www.gnu.org/licenses/>.
+ */
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "catch2/catch.hpp"
+#include "libsanjego/transposition.hpp"
+
+// To make the test cases more readable
+using namespace libsanjego;
+
+TEST_CASE("Probing an empty table misses", "[fast]") {
+  TranspositionTable table(1);
+  REQUIRE_FALSE(table.Probe(42).has_value());
+  REQUIRE(table.statistics().misses == 1);
+  REQUIRE(table.statistics().hits == 0);
+}
+
+TEST_CASE("Stored entries can be probed", "[fast]") {
+  TranspositionTable table(1);
+  const TranspositionEntry entry{-3, 5, Bound::Lower, Move{{1, 2}, {1, 3}}};
+  table.Store(42, entry);
+
+  const auto probed_entry = table.Probe(42);
+  REQUIRE(probed_entry.has_value());
+  REQUIRE(probed_entry->score == -3);
+  REQUIRE(probed_entry->depth == 5);
+  REQUIRE(probed_entry->bound == Bound::Lower);
+  REQUIRE(probed_entry->best_move == Move{{1, 2}, {1, 3}});
+  REQUIRE(table.statistics().hits == 1);
+}
+
+TEST_CASE("A table has a power of two slots", "[fast]") {
+  const TranspositionTable table(3);
+  const auto capacity = table.capacity();
+  REQUIRE(capacity > 0);
+  REQUIRE((capacity & (capacity - 1)) == 0);
+}
+
+TEST_CASE("Deeper entries are kept on collisions", "[fast]") {
+  TranspositionTable table(1);
+  // keys mapping to the same slot
+  const uint64_t key = 7;
+  const uint64_t other_key = key + table.capacity();
+
+  table.Store(key, {1, 6, Bound::Exact, Move::Skip()});
+  table.Store(other_key, {2, 3, Bound::Exact, Move::Skip()});
+
+  REQUIRE(table.Probe(key).has_value());
+  REQUIRE_FALSE(table.Probe(other_key).has_value());
+  REQUIRE(table.statistics().collisions == 1);
+}
+
+TEST_CASE("Entries of earlier searches are replaced on collisions", "[fast]") {
+  TranspositionTable table(1);
+  const uint64_t key = 7;
+  const uint64_t other_key = key + table.capacity();
+
+  table.Store(key, {1, 6, Bound::Exact, Move::Skip()});
+  table.NewSearch();
+  table.Store(other_key, {2, 3, Bound::Exact, Move::Skip()});
+
+  REQUIRE_FALSE(table.Probe(key).has_value());
+  REQUIRE(table.Probe(other_key).has_value());
+}
+
+TEST_CASE("Cleared tables are empty", "[fast]") {
+  TranspositionTable table(1);
+  table.Store(42, {1, 6, Bound::Exact, Move::Skip()});
+  table.Clear();
+  REQUIRE_FALSE(table.Probe(42).has_value());
+}
+
+TEST_CASE("Concurrent accesses never yield corrupted entries", "[fast]") {
+  TranspositionTable table(1);
+  // all keys map to the same slot, so the threads constantly overwrite
+  // each other's entries
+  const auto capacity = table.capacity();
+  // Catch's assertions are not thread-safe
+  std::atomic<uint64_t> num_corrupted_entries = 0;
+  std::vector<std::thread> threads;
+  for (uint64_t thread = 1; thread <= 4; ++thread) {
+    threads.emplace_back([&table, &num_corrupted_entries, capacity, thread] {
+      for (uint64_t i = 0; i < 10000; ++i) {
+        const auto key = thread * capacity;
+        // the score identifies the writer
+        table.Store(key, {static_cast<int16_t>(thread), 1, Bound::Exact,
+                          Move::Skip()});
+        const auto entry = table.Probe(key);
+        if (entry.has_value() && entry->score != thread) {
+          ++num_corrupted_entries;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  REQUIRE(num_corrupted_entries == 0);
+}